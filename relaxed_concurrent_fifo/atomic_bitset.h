@@ -1,12 +1,15 @@
 #ifndef ATOMIC_BITSET_H_INCLUDED
 #define ATOMIC_BITSET_H_INCLUDED
 
+#include <algorithm>
 #include <cstdint>
 #include <atomic>
 #include <cassert>
 #include <limits>
+#include <memory>
 #include <random>
 
+#include "backoff.h"
 #include "utility.h"
 
 #ifndef BITSET_DEFAULT_MEMORY_ORDER
@@ -23,11 +26,16 @@ enum class claim_mode {
     READ_ONLY,
 };
 
-template <typename ARR_TYPE = std::uint8_t>
+template <typename ARR_TYPE = std::uint8_t, typename Allocator = std::allocator<std::byte>, bool PACKED = false, backoff_policy BACKOFF = backoff_none>
 class atomic_bitset {
 private:
     static_assert(sizeof(ARR_TYPE) <= 4, "Inner bitset type must be 4 bytes or smaller to allow for storing epoch.");
 
+    // Packed units share cache lines, trading false sharing for a smaller footprint.
+    using unit_t = std::conditional_t<PACKED, std::atomic<std::uint64_t>, cache_aligned_t<std::atomic<std::uint64_t>>>;
+    using unit_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<unit_t>;
+    static_assert(std::is_trivially_destructible_v<unit_t>);
+
 #ifndef NDEBUG
     std::size_t window_count;
     std::size_t blocks_per_window;
@@ -36,7 +44,13 @@ private:
     std::size_t units_per_window_mod_mask;
 
     static constexpr std::size_t bit_count = sizeof(ARR_TYPE) * 8;
-    std::unique_ptr<cache_aligned_t<std::atomic<std::uint64_t>>[]> data;
+    std::size_t unit_count;
+    [[no_unique_address]] unit_allocator_t alloc;
+    unit_t* data;
+
+    std::atomic<std::uint64_t>& unit(std::size_t index) const {
+        return data[index];
+    }
 
     static constexpr std::uint64_t get_epoch(std::uint64_t epoch_and_bits) { return epoch_and_bits >> 32; }
     static constexpr std::uint64_t get_bits(std::uint64_t epoch_and_bits) { return epoch_and_bits & 0xffff'ffff; }
@@ -86,6 +100,7 @@ private:
                     test = raw | (1ull << original_index);
                 }
                 // Keep retrying until the bit we are trying to claim has changed.
+                BACKOFF backoff;
                 while (true) {
                     if (epoch_and_bits.compare_exchange_weak(eb,
                         VALUE == claim_value::ONE && test == 0
@@ -105,6 +120,7 @@ private:
                     if (test == raw) [[unlikely]] {
                         break;
                     }
+                    backoff();
                 }
             } else {
                 return original_index;
@@ -113,33 +129,49 @@ private:
     }
 
 public:
-    atomic_bitset(std::size_t window_count, std::size_t blocks_per_window) :
+    atomic_bitset(std::size_t window_count, std::size_t blocks_per_window, const Allocator& alloc = {}) :
 #ifndef NDEBUG
             window_count(window_count),
             blocks_per_window(blocks_per_window),
 #endif
             units_per_window(blocks_per_window / bit_count),
             units_per_window_mod_mask((blocks_per_window / bit_count) - 1),
-            data(std::make_unique<cache_aligned_t<std::atomic<std::uint64_t>>[]>(window_count * units_per_window)) {
+            unit_count(window_count * units_per_window),
+            alloc(alloc),
+            data(std::allocator_traits<unit_allocator_t>::allocate(this->alloc, unit_count)) {
         assert(blocks_per_window % bit_count == 0);
+        for (std::size_t i = 0; i < unit_count; i++) {
+            std::allocator_traits<unit_allocator_t>::construct(this->alloc, data + i);
+        }
+    }
+
+    ~atomic_bitset() {
+        std::allocator_traits<unit_allocator_t>::deallocate(alloc, data, unit_count);
+    }
+
+    atomic_bitset(const atomic_bitset&) = delete;
+    atomic_bitset& operator=(const atomic_bitset&) = delete;
+
+    std::size_t allocated_size() const {
+        return unit_count * sizeof(unit_t);
     }
 
     constexpr void set(std::size_t window_index, std::size_t index, std::uint64_t epoch, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) {
         assert(window_index < window_count);
         assert(index < blocks_per_window);
-        set_bit_atomic<true>(data[window_index * units_per_window + index / bit_count], index % bit_count, epoch, order);
+        set_bit_atomic<true>(unit(window_index * units_per_window + index / bit_count), index % bit_count, epoch, order);
     }
 
     constexpr void reset(std::size_t window_index, std::size_t index, std::uint64_t epoch, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) {
         assert(window_index < window_count);
         assert(index < blocks_per_window);
-        set_bit_atomic<false>(data[window_index * units_per_window + index / bit_count], index % bit_count, epoch, order);
+        set_bit_atomic<false>(unit(window_index * units_per_window + index / bit_count), index % bit_count, epoch, order);
     }
 
     [[nodiscard]] constexpr bool test(std::size_t window_index, std::size_t index, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) const {
         assert(window_index < window_count);
         assert(index < blocks_per_window);
-        return data[window_index * units_per_window + index / bit_count]->load(order) & (1ull << (index % bit_count));
+        return unit(window_index * units_per_window + index / bit_count).load(order) & (1ull << (index % bit_count));
     }
 
     [[nodiscard]] constexpr bool operator[](std::size_t index) const {
@@ -148,7 +180,7 @@ public:
 
     [[nodiscard]] constexpr bool any(std::size_t window_index, std::uint64_t epoch, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) const {
         for (std::size_t i = 0; i < units_per_window; i++) {
-            std::uint64_t eb = data[window_index * units_per_window + i]->load(order);
+            std::uint64_t eb = unit(window_index * units_per_window + i).load(order);
             if (get_epoch(eb) == epoch && get_bits(eb)) {
                 return true;
             }
@@ -160,7 +192,26 @@ public:
         std::uint64_t next_eb = make_unit(epoch + 1);
         for (std::size_t i = 0; i < units_per_window; i++) {
             std::uint64_t eb = make_unit(epoch);
-            data[window_index * units_per_window + i]->compare_exchange_strong(eb, next_eb, order);
+            unit(window_index * units_per_window + i).compare_exchange_strong(eb, next_eb, order);
+        }
+    }
+
+    // Not thread-safe, clears all bits of the window and sets its epoch.
+    void reset_window(std::size_t window_index, std::uint64_t epoch) {
+        assert(window_index < window_count);
+        for (std::size_t i = 0; i < units_per_window; i++) {
+            unit(window_index * units_per_window + i).store(make_unit(epoch), std::memory_order_relaxed);
+        }
+    }
+
+    // Not thread-safe, sets exactly the first count bits of the window and its epoch.
+    void set_first(std::size_t window_index, std::size_t count, std::uint64_t epoch) {
+        assert(window_index < window_count);
+        assert(count <= blocks_per_window);
+        for (std::size_t i = 0; i < units_per_window; i++) {
+            std::size_t bits = std::min(bit_count, count - std::min(count, i * bit_count));
+            ARR_TYPE raw = bits == bit_count ? static_cast<ARR_TYPE>(~ARR_TYPE{ 0 }) : static_cast<ARR_TYPE>((1ull << bits) - 1);
+            unit(window_index * units_per_window + i).store(make_unit(epoch) | raw, std::memory_order_relaxed);
         }
     }
 
@@ -172,7 +223,7 @@ public:
         int initial_rot = starting_bit % bit_count;
         for (std::size_t i = 0; i < units_per_window; i++) {
             auto index = (i + off) & units_per_window_mod_mask;
-            if (auto ret = claim_bit_singular<VALUE, MODE>(data[window_index * units_per_window + index], initial_rot, epoch, order);
+            if (auto ret = claim_bit_singular<VALUE, MODE>(unit(window_index * units_per_window + index), initial_rot, epoch, order);
                     ret != std::numeric_limits<std::size_t>::max()) {
                 return ret + index * bit_count;
             }
@@ -8,13 +8,20 @@
 #include <atomic>
 #include <cassert>
 #include <limits>
+#include <memory>
 #include <random>
 
+#include "backoff.h"
 #include "utility.h"
 
-template <typename ARR_TYPE = std::uint8_t>
+template <typename ARR_TYPE = std::uint8_t, typename Allocator = std::allocator<std::byte>, bool PACKED = false, backoff_policy BACKOFF = backoff_none>
 class atomic_bitset_no_epoch {
 private:
+    // Packed units share cache lines, trading false sharing for a smaller footprint.
+    using unit_t = std::conditional_t<PACKED, std::atomic<ARR_TYPE>, cache_aligned_t<std::atomic<ARR_TYPE>>>;
+    using unit_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<unit_t>;
+    static_assert(std::is_trivially_destructible_v<unit_t>);
+
 #ifndef NDEBUG
     std::size_t window_count;
     std::size_t blocks_per_window;
@@ -23,7 +30,13 @@ private:
     std::size_t units_per_window_mod_mask;
 
     static constexpr std::size_t bit_count = sizeof(ARR_TYPE) * 8;
-    std::unique_ptr<cache_aligned_t<std::atomic<ARR_TYPE>>[]> data;
+    std::size_t unit_count;
+    [[no_unique_address]] unit_allocator_t alloc;
+    unit_t* data;
+
+    std::atomic<ARR_TYPE>& unit(std::size_t index) const {
+        return data[index];
+    }
 
     template <bool SET>
     static constexpr void set_bit_atomic(std::atomic<ARR_TYPE>& bits, std::size_t index, std::memory_order order) {
@@ -53,6 +66,7 @@ private:
                     test = raw | (1ull << original_index);
                 }
                 // Keep retrying until the bit we are trying to claim has changed.
+                BACKOFF backoff;
                 while (true) {
                     if (bits.compare_exchange_weak(raw, test, order)) {
                         return original_index;
@@ -65,6 +79,7 @@ private:
                     if (test == raw) [[unlikely]] {
                         break;
                     }
+                    backoff();
                 }
             } else {
                 return original_index;
@@ -73,27 +88,62 @@ private:
     }
 
 public:
-    atomic_bitset_no_epoch(std::size_t window_count, std::size_t blocks_per_window) :
+    atomic_bitset_no_epoch(std::size_t window_count, std::size_t blocks_per_window, const Allocator& alloc = {}) :
 #ifndef NDEBUG
             window_count(window_count),
             blocks_per_window(blocks_per_window),
 #endif
             units_per_window(blocks_per_window / bit_count),
             units_per_window_mod_mask((blocks_per_window / bit_count) - 1),
-            data(std::make_unique<cache_aligned_t<std::atomic<ARR_TYPE>>[]>(window_count * units_per_window)) {
+            unit_count(window_count * units_per_window),
+            alloc(alloc),
+            data(std::allocator_traits<unit_allocator_t>::allocate(this->alloc, unit_count)) {
         assert(blocks_per_window % bit_count == 0);
+        for (std::size_t i = 0; i < unit_count; i++) {
+            std::allocator_traits<unit_allocator_t>::construct(this->alloc, data + i);
+        }
+    }
+
+    ~atomic_bitset_no_epoch() {
+        std::allocator_traits<unit_allocator_t>::deallocate(alloc, data, unit_count);
+    }
+
+    atomic_bitset_no_epoch(const atomic_bitset_no_epoch&) = delete;
+    atomic_bitset_no_epoch& operator=(const atomic_bitset_no_epoch&) = delete;
+
+    std::size_t allocated_size() const {
+        return unit_count * sizeof(unit_t);
     }
 
     constexpr void set(std::size_t window_index, std::size_t index, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) {
         assert(window_index < window_count);
         assert(index < blocks_per_window);
-        set_bit_atomic<true>(data[window_index * units_per_window + index / bit_count], index % bit_count, order);
+        set_bit_atomic<true>(unit(window_index * units_per_window + index / bit_count), index % bit_count, order);
     }
 
     constexpr void reset(std::size_t window_index, std::size_t index, std::memory_order order = BITSET_DEFAULT_MEMORY_ORDER) {
         assert(window_index < window_count);
         assert(index < blocks_per_window);
-        set_bit_atomic<false>(data[window_index * units_per_window + index / bit_count], index % bit_count, order);
+        set_bit_atomic<false>(unit(window_index * units_per_window + index / bit_count), index % bit_count, order);
+    }
+
+    // Not thread-safe, clears all bits of the window.
+    void reset_window(std::size_t window_index) {
+        assert(window_index < window_count);
+        for (std::size_t i = 0; i < units_per_window; i++) {
+            unit(window_index * units_per_window + i).store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Not thread-safe, sets exactly the first count bits of the window.
+    void set_first(std::size_t window_index, std::size_t count) {
+        assert(window_index < window_count);
+        assert(count <= blocks_per_window);
+        for (std::size_t i = 0; i < units_per_window; i++) {
+            std::size_t bits = std::min(bit_count, count - std::min(count, i * bit_count));
+            ARR_TYPE raw = bits == bit_count ? static_cast<ARR_TYPE>(~ARR_TYPE{ 0 }) : static_cast<ARR_TYPE>((1ull << bits) - 1);
+            unit(window_index * units_per_window + i).store(raw, std::memory_order_relaxed);
+        }
     }
 
     template <claim_value VALUE, claim_mode MODE>
@@ -104,7 +154,7 @@ public:
         int initial_rot = starting_bit % bit_count;
         for (std::size_t i = 0; i < units_per_window; i++) {
             auto index = (i + off) & units_per_window_mod_mask;
-            if (auto ret = claim_bit_singular<VALUE, MODE>(data[window_index * units_per_window + index], initial_rot, order);
+            if (auto ret = claim_bit_singular<VALUE, MODE>(unit(window_index * units_per_window + index), initial_rot, order);
                     ret != std::numeric_limits<std::size_t>::max()) {
                 return ret + index * bit_count;
             }
@@ -0,0 +1,69 @@
+#ifndef BACKOFF_H_INCLUDED
+#define BACKOFF_H_INCLUDED
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
+// Backoff policies for retry loops around contended CASes. A retry loop default-constructs one policy object
+// and invokes it after every failed attempt, so stateful policies restart from scratch for every operation.
+
+inline void cpu_pause() {
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_IX86)
+	_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+	asm volatile("yield");
+#endif
+}
+
+// Retries immediately.
+struct backoff_none {
+	void operator()() { }
+};
+
+// Issues a single pause instruction per retry, freeing pipeline resources for an SMT sibling.
+struct backoff_pause {
+	void operator()() { cpu_pause(); }
+};
+
+// Doubles the number of pause instructions per retry, up to MAX_PAUSES.
+template <std::uint32_t MAX_PAUSES = 1024>
+struct backoff_exponential {
+	std::uint32_t pauses = 1;
+
+	void operator()() {
+		for (std::uint32_t i = 0; i < pauses; i++) {
+			cpu_pause();
+		}
+		pauses = std::min(pauses * 2, MAX_PAUSES);
+	}
+};
+
+// Gives up the rest of the time slice, letting a preempted thread holding up progress run when oversubscribed.
+struct backoff_yield {
+	void operator()() { std::this_thread::yield(); }
+};
+
+template <typename B>
+concept backoff_policy = std::default_initializable<B> && std::invocable<B&>;
+
+// The backoff policy a queue was configured with, or backoff_none for queues without one.
+template <typename FIFO>
+struct fifo_backoff {
+	using type = backoff_none;
+};
+
+template <typename FIFO> requires requires { typename FIFO::backoff_t; }
+struct fifo_backoff<FIFO> {
+	using type = typename FIFO::backoff_t;
+};
+
+template <typename FIFO>
+using fifo_backoff_t = typename fifo_backoff<FIFO>::type;
+
+#endif // BACKOFF_H_INCLUDED
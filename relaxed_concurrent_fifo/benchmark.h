@@ -2,14 +2,32 @@
 #define BENCHMARK_H_INCLUDED
 
 #include "benchmarks/benchmark_default.hpp"
+#include "benchmarks/benchmark_latency.hpp"
 #include "benchmarks/benchmark_quality.hpp"
 #include "benchmarks/benchmark_empty.hpp"
 #include "benchmarks/benchmark_fill.hpp"
 #include "benchmarks/benchmark_prodcon.hpp"
 #include "benchmarks/benchmark_graph.hpp"
 #include "benchmarks/benchmark_graph_multistart.hpp"
+#include "benchmarks/benchmark_many_queues.hpp"
+#include "benchmarks/benchmark_reuse.hpp"
+#include "benchmarks/benchmark_bulk_load.hpp"
+#include "benchmarks/benchmark_snapshot.hpp"
+#include "benchmarks/benchmark_epoll.hpp"
+#include "benchmarks/benchmark_partitioned.hpp"
+#include "benchmarks/benchmark_pq_throughput.hpp"
+#include "benchmarks/benchmark_pq_quality.hpp"
+#include "benchmarks/benchmark_delay_queue.hpp"
+#include "benchmarks/benchmark_weighted.hpp"
+#include "benchmarks/benchmark_open_loop.hpp"
+#include "benchmarks/benchmark_synthetic.hpp"
+#include "benchmarks/benchmark_pipeline.hpp"
+#include "benchmarks/benchmark_fork_join.hpp"
+#include "benchmarks/benchmark_work_stealing.hpp"
+#include "benchmarks/process_isolation.hpp"
 
 #include "benchmarks/providers/benchmark_provider_generic.hpp"
 #include "benchmarks/providers/benchmark_provider_other.hpp"
+#include "benchmarks/providers/benchmark_provider_hugepage.hpp"
 
 #endif // BENCHMARK_H_INCLUDED
@@ -1,10 +1,19 @@
 #ifndef BENCHMARK_BASE_HPP_INCLUDED
 #define BENCHMARK_BASE_HPP_INCLUDED
 
+#include <atomic>
+#include <barrier>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <new>
+#include <optional>
+#include <random>
 #include <thread>
 
+#include "perf_counters.hpp"
+#include "../utility.h"
+
 // There are two components to a benchmark:
 // The benchmark itself which dictates what each thread does and what exactly is being measured;
 // and the benchmark provider, which effectively provides a concrete queue implementation to the benchmark.
@@ -14,6 +23,41 @@ struct benchmark_info {
     int test_time_seconds;
 };
 
+// Simulates work of the given duration without giving up the processor.
+inline void busy_wait(std::uint64_t nanos) {
+    if (nanos == 0) {
+        return;
+    }
+    auto until = std::chrono::steady_clock::now() + std::chrono::nanoseconds(nanos);
+    while (std::chrono::steady_clock::now() < until) { }
+}
+
+// Arrival times in nanoseconds since the start of the run for one of producer_count producers that together offer rate
+// elements per second, either as a Poisson process or evenly spaced.
+class arrival_schedule {
+private:
+    std::minstd_rand rng;
+    std::exponential_distribution<double> poisson_gaps;
+    double constant_gap;
+    bool poisson;
+    double next_arrival = 0;
+
+public:
+    arrival_schedule(double rate, int producer_count, bool poisson, int seed) :
+        rng(static_cast<std::minstd_rand::result_type>(seed + 1)),
+        poisson_gaps(rate / producer_count / 1e9),
+        constant_gap(1e9 * producer_count / rate),
+        poisson(poisson) { }
+
+    double next() const {
+        return next_arrival;
+    }
+
+    void advance() {
+        next_arrival += poisson ? poisson_gaps(rng) : constant_gap;
+    }
+};
+
 template <bool HAS_TIMEOUT_T = true, bool RECORD_TIME_T = false, bool PREFILL_IN_ORDER_T = false>
 struct benchmark_base {
     static constexpr bool HAS_TIMEOUT = HAS_TIMEOUT_T;
@@ -21,6 +65,25 @@ struct benchmark_base {
     static constexpr bool PREFILL_IN_ORDER = PREFILL_IN_ORDER_T;
 
     std::size_t fifo_size = static_cast<std::size_t>(4) * std::thread::hardware_concurrency() * std::thread::hardware_concurrency() * std::thread::hardware_concurrency();
+
+    // Filled by benchmark_provider::test_single if perf_counter_group::enabled is set, counting from start_measurement on.
+    perf_counter_values perf_counters;
+
+    // Set by benchmark_provider::test_single while sampling a time series, one cache line per thread.
+    cache_aligned_t<std::atomic_uint64_t>* progress = nullptr;
+
+    // To be called by every thread in place of a.arrive_and_wait() right before the measured part of per_thread,
+    // so that perf counters include neither the prefill nor the time spent waiting for the other threads.
+    static void start_measurement(std::barrier<>& a) {
+        a.arrive_and_wait();
+        perf_counter_group::start_current();
+    }
+
+    void record_progress(int thread_index, std::uint64_t operations) {
+        if (progress != nullptr) {
+            progress[thread_index]->store(operations, std::memory_order_relaxed);
+        }
+    }
 };
 
 template <bool PREFILL_IN_ORDER = false, bool HAS_TIMEOUT = false>
@@ -0,0 +1,59 @@
+#ifndef BENCHMARK_BULK_LOAD_HPP_INCLUDED
+#define BENCHMARK_BULK_LOAD_HPP_INCLUDED
+
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <thread>
+#include <vector>
+
+// Compares prefilling a queue by pushing from every thread (as benchmark_provider::test_single does)
+// against loading the same elements with block_based_queue::assign.
+struct benchmark_bulk_load_result {
+    std::size_t elements;
+    std::uint64_t push_nanos;
+    std::uint64_t assign_nanos;
+};
+
+template <typename FIFO, typename... Args>
+benchmark_bulk_load_result benchmark_bulk_load(int num_threads, std::size_t elements, Args... args) {
+    benchmark_bulk_load_result result{ elements, 0, 0 };
+
+    {
+        FIFO fifo{ num_threads, elements * 2, args... };
+        std::barrier a{ num_threads + 1 };
+        std::vector<std::jthread> threads(num_threads);
+        for (int i = 0; i < num_threads; i++) {
+            threads[i] = std::jthread([&, i]() {
+                auto handle = fifo.get_handle();
+                std::size_t first = elements * i / num_threads;
+                std::size_t last = elements * (i + 1) / num_threads;
+                a.arrive_and_wait();
+                for (std::size_t j = first; j < last; j++) {
+                    if (!handle.push(j + 1)) {
+                        break;
+                    }
+                }
+            });
+        }
+        a.arrive_and_wait();
+        auto start = std::chrono::steady_clock::now();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        result.push_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    {
+        FIFO fifo{ num_threads, elements * 2, args... };
+        auto start = std::chrono::steady_clock::now();
+        result.elements = fifo.assign(std::views::iota(static_cast<std::uint64_t>(1), elements + 1), num_threads);
+        result.assign_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    return result;
+}
+
+#endif // BENCHMARK_BULK_LOAD_HPP_INCLUDED
@@ -2,34 +2,48 @@
 #define BENCHMARK_DEFAULT_HPP_INCLUDED
 
 #include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+#include "thread_distribution.hpp"
 
 #include <vector>
 #include <barrier>
 #include <numeric>
 
-struct benchmark_default : benchmark_base<> {
+struct benchmark_default : benchmark_base<>, latency_recorder {
     std::vector<std::size_t> results;
     std::size_t test_time_seconds;
 
-    benchmark_default(const benchmark_info& info) : results(info.num_threads), test_time_seconds(info.test_time_seconds) {}
+    benchmark_default(const benchmark_info& info) : latency_recorder(info.num_threads), results(info.num_threads), test_time_seconds(info.test_time_seconds) {}
 
     template <typename T>
     void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
         std::size_t its = 0;
-        a.arrive_and_wait();
+        auto sample = get_sampler(thread_index);
+        start_measurement(a);
         while (!over) {
-            handle.push(5);
-            handle.pop();
+            sample([&]() { return handle.push(5); });
+            sample([&]() { return handle.pop(); });
             its++;
+            record_progress(thread_index, its);
         }
         results[thread_index] = its;
     }
 
-    static constexpr const char* header = "iterations_per_second";
+    static constexpr const char* header = "iterations_per_second," THREAD_DISTRIBUTION_HEADER;
+
+    const std::vector<std::size_t>& thread_operations() const {
+        return results;
+    }
+
+    std::uint64_t operation_count() const {
+        // Every iteration is a push and a pop.
+        return 2 * std::reduce(results.begin(), results.end());
+    }
 
     template <typename T>
     void output(T& stream) {
-        stream << std::reduce(results.begin(), results.end()) / test_time_seconds;
+        stream << std::reduce(results.begin(), results.end()) / test_time_seconds << ',';
+        thread_distribution::output(stream, results);
     }
 };
 
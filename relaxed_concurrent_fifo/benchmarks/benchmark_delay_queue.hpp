@@ -0,0 +1,97 @@
+#ifndef BENCHMARK_DELAY_QUEUE_HPP_INCLUDED
+#define BENCHMARK_DELAY_QUEUE_HPP_INCLUDED
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../delay_queue.h"
+
+struct benchmark_delay_queue_result {
+    std::uint64_t pushes_per_second;
+    std::uint64_t pops_per_second;
+    // Pushes rejected because their slot was full.
+    std::uint64_t failed_pushes;
+    // Elements returned before their deadline, must be 0.
+    std::uint64_t early_pops;
+    // Time between deadline and pop.
+    double mean_lateness_nanos;
+};
+
+// Every thread alternates scheduling an element with a uniformly random delay in [0, max_delay) and popping an expired one.
+// Elements carry their own deadline, so pops can check it.
+template <typename... Args>
+benchmark_delay_queue_result benchmark_delay_queue(int num_threads, int test_time_seconds, std::size_t size, std::size_t slot_count,
+    std::chrono::nanoseconds slot_duration, std::chrono::nanoseconds max_delay, Args... args) {
+    using clock = delay_queue::clock;
+    delay_queue queue{ num_threads, size, slot_count, slot_duration, args... };
+
+    struct thread_result {
+        std::uint64_t pushes = 0;
+        std::uint64_t pops = 0;
+        std::uint64_t failed_pushes = 0;
+        std::uint64_t early_pops = 0;
+        double lateness_sum = 0;
+    };
+
+    std::barrier a{ num_threads + 1 };
+    std::atomic_bool over = false;
+    std::vector<thread_result> results(num_threads);
+    std::vector<std::jthread> threads(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+        threads[i] = std::jthread([&, i]() {
+            auto handle = queue.get_handle();
+            std::minstd_rand rng{ static_cast<std::minstd_rand::result_type>(i + 1) };
+            std::uniform_int_distribution<std::int64_t> delays{ 0, max_delay.count() - 1 };
+            thread_result result;
+            a.arrive_and_wait();
+            while (!over.load(std::memory_order_relaxed)) {
+                auto now = clock::now();
+                auto deadline = now + std::chrono::nanoseconds{ delays(rng) };
+                // Offset by one, zero is not a valid element.
+                std::uint64_t element = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - queue.start_time()).count() + 1;
+                if (handle.push(element, deadline)) {
+                    result.pushes++;
+                } else {
+                    result.failed_pushes++;
+                }
+
+                if (auto popped = handle.pop(now); popped.has_value()) {
+                    auto now_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(now - queue.start_time()).count();
+                    auto deadline_nanos = static_cast<std::int64_t>(*popped - 1);
+                    if (deadline_nanos > now_nanos) {
+                        result.early_pops++;
+                    }
+                    result.lateness_sum += now_nanos - deadline_nanos;
+                    result.pops++;
+                }
+            }
+            results[i] = result;
+        });
+    }
+
+    a.arrive_and_wait();
+    std::this_thread::sleep_for(std::chrono::seconds(test_time_seconds));
+    over = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto total = std::accumulate(results.begin(), results.end(), thread_result{}, [](thread_result sum, const thread_result& r) {
+        sum.pushes += r.pushes;
+        sum.pops += r.pops;
+        sum.failed_pushes += r.failed_pushes;
+        sum.early_pops += r.early_pops;
+        sum.lateness_sum += r.lateness_sum;
+        return sum;
+    });
+    return { total.pushes / test_time_seconds, total.pops / test_time_seconds, total.failed_pushes, total.early_pops,
+        total.pops == 0 ? 0 : total.lateness_sum / total.pops };
+}
+
+#endif // BENCHMARK_DELAY_QUEUE_HPP_INCLUDED
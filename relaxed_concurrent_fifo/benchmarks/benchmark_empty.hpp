@@ -6,10 +6,12 @@
 struct benchmark_empty : benchmark_fill {
     template <typename T>
     void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
-        a.arrive_and_wait();
+        auto sample = get_sampler(thread_index);
+        start_measurement(a);
         std::size_t its = 0;
-        while (handle.pop().has_value() && !over) {
+        while (sample([&]() { return handle.pop(); }).has_value() && !over) {
             its++;
+            record_progress(thread_index, its);
         }
         results[thread_index] = its;
     }
@@ -0,0 +1,119 @@
+#ifndef BENCHMARK_EPOLL_HPP_INCLUDED
+#define BENCHMARK_EPOLL_HPP_INCLUDED
+
+#ifdef __linux__
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "../notifying_fifo.h"
+
+struct benchmark_epoll_result {
+    std::uint64_t elements;
+    std::uint64_t wakeups;
+    // eventfd writes by the producers.
+    std::uint64_t producer_syscalls;
+    // epoll_wait and eventfd reads by the consumer.
+    std::uint64_t consumer_syscalls;
+    // From the push of the first element after the consumer blocked until the consumer popped an element.
+    double mean_wakeup_latency_nanos;
+    // From push to pop, over all elements.
+    double mean_latency_nanos;
+};
+
+// A single consumer thread runs an epoll loop on a notifying_fifo, draining it completely on every wakeup,
+// while num_threads producers push bursts of timestamps with a pause in between, so the consumer regularly goes idle.
+template <typename FIFO, typename... Args>
+benchmark_epoll_result benchmark_epoll(int num_threads, int test_time_seconds, int burst, std::chrono::microseconds pause, Args... args) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    auto now_nanos = [&]() -> std::uint64_t {
+        // Offset by one, zero is not a valid element.
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() + 1;
+    };
+
+    notifying_fifo<FIFO> fifo{ num_threads + 1, static_cast<std::size_t>(num_threads * burst * 64), args... };
+    benchmark_epoll_result result{ };
+
+    std::barrier a{ num_threads + 2 };
+    std::atomic_bool over = false;
+    std::vector<std::jthread> producers(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+        producers[i] = std::jthread([&]() {
+            auto handle = fifo.get_handle();
+            a.arrive_and_wait();
+            while (!over.load(std::memory_order_relaxed)) {
+                for (int j = 0; j < burst; j++) {
+                    handle.push(now_nanos());
+                }
+                std::this_thread::sleep_for(pause);
+            }
+        });
+    }
+
+    std::jthread consumer([&]() {
+        int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+            throw std::runtime_error("Failed to create epoll instance");
+        }
+        epoll_event event{ };
+        event.events = EPOLLIN;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fifo.fd(), &event);
+
+        auto handle = fifo.get_handle();
+        double latency_sum = 0;
+        double wakeup_latency_sum = 0;
+        std::uint64_t wakeup_samples = 0;
+        bool woken = false;
+        a.arrive_and_wait();
+        while (!over.load(std::memory_order_relaxed)) {
+            // Drain until the queue is found empty with the notifier armed.
+            while (auto value = handle.pop_or_arm()) {
+                auto latency = now_nanos() - *value;
+                latency_sum += latency;
+                if (woken) {
+                    wakeup_latency_sum += latency;
+                    wakeup_samples++;
+                    woken = false;
+                }
+                result.elements++;
+            }
+            woken = false;
+
+            // Time out regularly to notice the end of the benchmark.
+            result.consumer_syscalls++;
+            if (epoll_wait(epoll_fd, &event, 1, 10) == 1) {
+                result.consumer_syscalls++;
+                fifo.consume_notification();
+                result.wakeups++;
+                woken = true;
+            }
+        }
+        close(epoll_fd);
+        result.mean_latency_nanos = result.elements == 0 ? 0 : latency_sum / result.elements;
+        result.mean_wakeup_latency_nanos = wakeup_samples == 0 ? 0 : wakeup_latency_sum / wakeup_samples;
+    });
+
+    a.arrive_and_wait();
+    std::this_thread::sleep_for(std::chrono::seconds(test_time_seconds));
+    over = true;
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    consumer.join();
+
+    result.producer_syscalls = fifo.notifications();
+    return result;
+}
+
+#endif // __linux__
+
+#endif // BENCHMARK_EPOLL_HPP_INCLUDED
@@ -2,29 +2,42 @@
 #define BENCHMARK_FILL_HPP_INCLUDED
 
 #include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+#include "thread_distribution.hpp"
 
-struct benchmark_fill : benchmark_timed<false, true> {
+struct benchmark_fill : benchmark_timed<false, true>, latency_recorder {
     std::vector<std::uint64_t> results;
 
-    benchmark_fill(const benchmark_info& info) : results(info.num_threads) {
+    benchmark_fill(const benchmark_info& info) : latency_recorder(info.num_threads), results(info.num_threads) {
         fifo_size = 1 << 28;
     }
 
     template <typename T>
     void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
-        a.arrive_and_wait();
+        auto sample = get_sampler(thread_index);
+        start_measurement(a);
         std::size_t its = 0;
-        while (handle.push(thread_index + 1) && !over) {
+        while (sample([&]() { return handle.push(thread_index + 1); }) && !over) {
             its++;
+            record_progress(thread_index, its);
         }
         results[thread_index] = its;
     }
 
-    static constexpr const char* header = "operations_per_nanosecond";
+    static constexpr const char* header = "operations_per_nanosecond," THREAD_DISTRIBUTION_HEADER;
+
+    const std::vector<std::uint64_t>& thread_operations() const {
+        return results;
+    }
+
+    std::uint64_t operation_count() const {
+        return std::reduce(results.begin(), results.end());
+    }
 
     template <typename T>
     void output(T& stream) {
-        stream << static_cast<double>(std::reduce(results.begin(), results.end())) / time_nanos;
+        stream << static_cast<double>(std::reduce(results.begin(), results.end())) / time_nanos << ',';
+        thread_distribution::output(stream, results);
     }
 };
 
@@ -0,0 +1,182 @@
+#ifndef BENCHMARK_FORK_JOIN_HPP_INCLUDED
+#define BENCHMARK_FORK_JOIN_HPP_INCLUDED
+
+#include "benchmark_base.hpp"
+
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include "../backoff.h"
+#include "../contenders/multififo/util/termination_detection.hpp"
+
+// Recursive divide-and-conquer workloads whose tasks fit into a single (non-zero) uint64_t.
+enum class fork_join_workload {
+    // Naive Fibonacci recursion down to a sequential cutoff. A task is n + 1.
+    FIB,
+    // Unbalanced tree search on a binomial tree: The root has size children, every other node has
+    // UTS_M children with probability UTS_Q and none otherwise. A task is the node's random state.
+    UTS,
+};
+
+namespace fork_join {
+    constexpr std::uint64_t FIB_CUTOFF = 10;
+    constexpr std::uint64_t UTS_M = 8;
+    // m * q slightly below 1 keeps the tree finite while making subtree sizes vary wildly.
+    constexpr double UTS_Q = 0.124;
+    constexpr std::uint64_t UTS_ROOT = 1;
+
+    inline std::uint64_t splitmix64(std::uint64_t x) {
+        x += 0x9e3779b97f4a7c15;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+        return x ^ (x >> 31);
+    }
+
+    inline std::uint64_t fib(std::uint64_t n) {
+        return n < 2 ? n : fib(n - 1) + fib(n - 2);
+    }
+
+    inline std::uint64_t uts_child_count(std::uint64_t node, std::uint64_t root_children) {
+        if (node == UTS_ROOT) {
+            return root_children;
+        }
+        double uniform = static_cast<double>(splitmix64(node) >> 11) * 0x1.0p-53;
+        return uniform < UTS_Q ? UTS_M : 0;
+    }
+
+    // Bit 1 is always set, so children never collide with the root (or 0).
+    inline std::uint64_t uts_child(std::uint64_t node, std::uint64_t index) {
+        return splitmix64(node ^ ((index + 1) * 0xd1b54a32d192ed03)) | 2;
+    }
+
+    // Calls spawn for every child task, returns the contribution of the task itself to the result.
+    template <typename F>
+    std::uint64_t process(fork_join_workload workload, std::uint64_t size, std::uint64_t task, F&& spawn) {
+        if (workload == fork_join_workload::FIB) {
+            std::uint64_t n = task - 1;
+            if (n <= FIB_CUTOFF) {
+                return fib(n);
+            }
+            spawn(n);
+            spawn(n - 1);
+            return 0;
+        }
+        for (std::uint64_t i = 0, children = uts_child_count(task, size); i < children; i++) {
+            spawn(uts_child(task, i));
+        }
+        return 1;
+    }
+
+    inline std::uint64_t root_task(fork_join_workload workload, std::uint64_t size) {
+        return workload == fork_join_workload::FIB ? size + 1 : UTS_ROOT;
+    }
+
+    // Time, result and task count of processing the workload on a single thread with a stack.
+    inline std::tuple<std::uint64_t, std::uint64_t, std::uint64_t> sequential(fork_join_workload workload, std::uint64_t size) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::uint64_t> tasks{ root_task(workload, size) };
+        std::uint64_t result = 0;
+        std::uint64_t processed = 0;
+        while (!tasks.empty()) {
+            auto task = tasks.back();
+            tasks.pop_back();
+            result += process(workload, size, task, [&](std::uint64_t child) { tasks.push_back(child); });
+            processed++;
+        }
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        return { time, result, processed };
+    }
+}
+
+struct benchmark_info_fork_join : public benchmark_info {
+    fork_join_workload workload;
+    // n for FIB, the number of root children for UTS.
+    std::uint64_t size;
+    // Result of the sequential run to validate against.
+    std::uint64_t expected;
+};
+
+// The queue is the only task pool: Threads pop a task, run it and push its children, until termination detection
+// finds all threads idle at once. The result is the sum of all tasks' contributions (fib(n) or the tree size).
+struct benchmark_fork_join : benchmark_timed<> {
+    struct counter {
+        std::uint64_t result = 0;
+        std::uint64_t processed = 0;
+        std::uint64_t pushed = 0;
+        bool err = false;
+    };
+
+    const benchmark_info_fork_join& info;
+    termination_detection::TerminationDetection termination_detection;
+    std::vector<counter> counters;
+
+    benchmark_fork_join(const benchmark_info& info_base) :
+            info(reinterpret_cast<const benchmark_info_fork_join&>(info_base)),
+            termination_detection(info.num_threads),
+            counters(info.num_threads) {
+        fifo_size = 1 << 22;
+    }
+
+    template <typename FIFO>
+    void per_thread(int thread_index, typename FIFO::handle& handle, std::barrier<>& a) {
+        counter c;
+        auto spawn = [&](std::uint64_t child) {
+            if (!handle.push(child)) {
+                c.err = true;
+            }
+            ++c.pushed;
+        };
+        if (thread_index == 0) {
+            spawn(fork_join::root_task(info.workload, info.size));
+        }
+        a.arrive_and_wait();
+        std::optional<std::uint64_t> task;
+        while (termination_detection.repeat([&]() {
+                task = handle.pop();
+                return task.has_value();
+            }, fifo_backoff_t<FIFO>{})) {
+            c.result += fork_join::process(info.workload, info.size, *task, spawn);
+            ++c.processed;
+        }
+        counters[thread_index] = c;
+    }
+
+    static constexpr const char* header = "time_nanoseconds,result,tasks";
+
+    template <typename T>
+    void output(T& stream) {
+        counter total = std::accumulate(counters.begin(), counters.end(), counter{}, [](counter sum, const counter& c) {
+            sum.result += c.result;
+            sum.processed += c.processed;
+            sum.pushed += c.pushed;
+            sum.err |= c.err;
+            return sum;
+        });
+
+        if (total.err) {
+            std::cout << "Push failed!" << std::endl;
+            stream << "ERR_PUSH_FAIL";
+            return;
+        }
+        if (total.pushed != total.processed) {
+            std::cout << (total.pushed - total.processed) << " lost tasks!" << std::endl;
+            stream << "ERR_LOST_TASK";
+            return;
+        }
+        if (total.result != info.expected) {
+            std::cout << "Result is " << total.result << ", should be " << info.expected << std::endl;
+            stream << "ERR_RESULT_WRONG";
+            return;
+        }
+
+        stream << time_nanos << ',' << total.result << ',' << total.processed;
+    }
+};
+
+#endif // BENCHMARK_FORK_JOIN_HPP_INCLUDED
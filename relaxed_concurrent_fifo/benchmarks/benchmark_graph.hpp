@@ -6,6 +6,7 @@
 #include <optional>
 #include <iostream>
 
+#include "../backoff.h"
 #include "../utility.h"
 #include "../contenders/multififo/ring_buffer.hpp"
 #include "../contenders/multififo/util/graph.hpp"
@@ -35,6 +36,31 @@ std::tuple<std::uint64_t, std::uint32_t, std::vector<std::uint32_t>> sequential_
     return std::tuple(end - now, *std::max_element(distances.begin(), distances.end()), distances);
 }
 
+std::tuple<std::uint64_t, std::uint64_t> sequential_dfs(const Graph& graph, std::size_t start_node = 0) {
+    std::vector<std::uint32_t> nodes;
+    std::vector<bool> visited(graph.num_nodes(), false);
+    visited[start_node] = true;
+    std::uint64_t visited_nodes = 1;
+
+    nodes.push_back(static_cast<std::uint32_t>(start_node));
+
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    while (!nodes.empty()) {
+        auto node_id = nodes.back();
+        nodes.pop_back();
+        for (auto i = graph.nodes[node_id]; i < graph.nodes[node_id + 1]; ++i) {
+            auto new_node_id = graph.edges[i].target;
+            if (!visited[new_node_id]) {
+                visited[new_node_id] = true;
+                ++visited_nodes;
+                nodes.push_back(static_cast<std::uint32_t>(new_node_id));
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now().time_since_epoch().count();
+    return std::tuple(end - now, visited_nodes);
+}
+
 struct benchmark_info_graph : public benchmark_info {
     const Graph& graph;
     const std::vector<std::uint32_t>& distances;
@@ -74,8 +100,9 @@ struct benchmark_bfs : benchmark_timed<> {
         fifo_size = std::bit_ceil(graph.nodes.size());
     }
 
-    template <typename FIFO>
-    void process_node(std::uint64_t node, typename FIFO::handle& handle, Counter& counter) {
+    // HANDLE is a fifo handle or anything else with a matching push, e.g. a work_stealing_pool worker.
+    template <typename HANDLE>
+    void process_node(std::uint64_t node, HANDLE& handle, Counter& counter) {
         std::uint64_t node_id = node & 0xffff'ffff;
         std::uint32_t node_dist = node >> 32;
         auto current_distance = distances[node_id].value.load(std::memory_order_relaxed);
@@ -114,8 +141,8 @@ struct benchmark_bfs : benchmark_timed<> {
         while (termination_detection.repeat([&]() {
                 node = handle.pop();
                 return node.has_value();
-            })) {
-            process_node<FIFO>(*node, handle, counter);
+            }, fifo_backoff_t<FIFO>{})) {
+            process_node(*node, handle, counter);
         }
         counters[thread_index] = counter;
     }
@@ -171,4 +198,102 @@ struct benchmark_bfs : benchmark_timed<> {
     }
 };
 
+// Depth-first traversal of everything reachable from node 0, profiting from LIFO-ish containers.
+// Every node is pushed exactly once (the first thread to mark it visited pushes it), so the order only
+// affects locality and the amount of work in flight, not the amount of work.
+struct benchmark_dfs : benchmark_timed<> {
+    const benchmark_info_graph& info;
+    const Graph& graph;
+    std::vector<AtomicDistance> visited;
+    termination_detection::TerminationDetection termination_detection;
+    std::vector<Counter> counters;
+
+    benchmark_dfs(const benchmark_info& info_base) :
+            info(reinterpret_cast<const benchmark_info_graph&>(info_base)),
+            graph(info.graph),
+            visited(graph.num_nodes()),
+            termination_detection(info.num_threads),
+            counters(info.num_threads) {
+        fifo_size = std::bit_ceil(graph.nodes.size());
+    }
+
+    static constexpr std::uint32_t NOT_VISITED = std::numeric_limits<std::uint32_t>::max();
+
+    template <typename FIFO>
+    void process_node(std::uint64_t node, typename FIFO::handle& handle, Counter& counter) {
+        // Node ids are offset by one, as we can't push 0 to the queues.
+        std::uint64_t node_id = node - 1;
+        for (auto i = graph.nodes[node_id]; i < graph.nodes[node_id + 1]; ++i) {
+            auto target = graph.edges[i].target;
+            if (visited[target].value.load(std::memory_order_relaxed) == NOT_VISITED
+                    && visited[target].value.exchange(1, std::memory_order_relaxed) == NOT_VISITED) {
+                if (!handle.push(static_cast<std::uint64_t>(target) + 1)) {
+                    counter.err = true;
+                }
+                ++counter.pushed_nodes;
+            }
+        }
+        ++counter.processed_nodes;
+    }
+
+    template <typename FIFO>
+    void per_thread(int thread_index, typename FIFO::handle& handle, std::barrier<>& a) {
+        Counter counter;
+        if (thread_index == 0) {
+            visited[0].value = 1;
+            handle.push(1);
+            ++counter.pushed_nodes;
+        }
+        a.arrive_and_wait();
+        std::optional<std::uint64_t> node;
+        while (termination_detection.repeat([&]() {
+                node = handle.pop();
+                return node.has_value();
+            }, fifo_backoff_t<FIFO>{})) {
+            process_node<FIFO>(*node, handle, counter);
+        }
+        counters[thread_index] = counter;
+    }
+
+    static constexpr const char* header = "time_nanoseconds,visited_nodes,pushed_nodes,processed_nodes";
+
+    template <typename T>
+    void output(T& stream) {
+        auto total_counts =
+            std::accumulate(counters.begin(), counters.end(), Counter{}, [](auto sum, auto const& counter) {
+            sum.pushed_nodes += counter.pushed_nodes;
+            sum.processed_nodes += counter.processed_nodes;
+            sum.err |= counter.err;
+            return sum;
+        });
+
+        if (total_counts.err) {
+            std::cout << "Push failed!" << std::endl;
+            stream << "ERR_PUSH_FAIL";
+            return;
+        }
+
+        auto lost_nodes = total_counts.pushed_nodes - total_counts.processed_nodes;
+        if (lost_nodes != 0) {
+            std::cout << lost_nodes << " lost nodes!" << std::endl;
+            stream << "ERR_LOST_NODE";
+            return;
+        }
+
+        std::uint64_t visited_nodes = 0;
+        for (std::size_t i = 0; i < info.distances.size(); i++) {
+            bool reachable = info.distances[i] != std::numeric_limits<std::uint32_t>::max();
+            bool was_visited = visited[i].value != NOT_VISITED;
+            if (reachable != was_visited) {
+                std::cout << "Node " << i << (reachable ? " was not visited" : " was visited, but is unreachable") << std::endl;
+                stream << "ERR_VISITED_WRONG";
+                return;
+            }
+            visited_nodes += was_visited;
+        }
+
+        stream << time_nanos << ',' << visited_nodes << ',' << total_counts.pushed_nodes << ',' << total_counts.processed_nodes;
+    }
+};
+
 #endif // BENCHMARK_GRAPH_HPP_INCLUDED
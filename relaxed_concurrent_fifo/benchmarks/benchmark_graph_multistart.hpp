@@ -8,6 +8,7 @@
 
 #include "benchmark_graph.hpp"
 
+#include "../backoff.h"
 #include "../utility.h"
 #include "../contenders/multififo/ring_buffer.hpp"
 #include "../contenders/multififo/util/graph.hpp"
@@ -89,7 +90,7 @@ struct benchmark_bfs_multistart : benchmark_timed<> {
         while (termination_detection.repeat([&]() {
                 node = handle.pop();
                 return node.has_value();
-            })) {
+            }, fifo_backoff_t<FIFO>{})) {
             process_node<FIFO>(*node, handle, counter);
         }
         counters[thread_index] = counter;
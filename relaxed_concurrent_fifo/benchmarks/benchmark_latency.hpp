@@ -0,0 +1,51 @@
+#ifndef BENCHMARK_LATENCY_HPP_INCLUDED
+#define BENCHMARK_LATENCY_HPP_INCLUDED
+
+#include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+// Same workload as benchmark_default, but always recording latencies of every SAMPLE_INTERVAL-th operation,
+// independent of latency_recorder::sample_interval.
+// Under oversubscription, the tail of these latencies exposes preempted threads holding up others.
+struct benchmark_latency : benchmark_base<> {
+    static constexpr std::uint64_t SAMPLE_INTERVAL = 16;
+
+    std::vector<std::size_t> results;
+    latency_recorder::histograms latencies;
+    std::size_t test_time_seconds;
+
+    benchmark_latency(const benchmark_info& info) : results(info.num_threads), latencies(info.num_threads), test_time_seconds(info.test_time_seconds) {}
+
+    template <typename T>
+    void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
+        std::size_t its = 0;
+        latency_recorder::sampler sample{ latencies[thread_index], SAMPLE_INTERVAL };
+        start_measurement(a);
+        while (!over) {
+            sample([&]() { return handle.push(5); });
+            sample([&]() { return handle.pop(); });
+            its++;
+        }
+        results[thread_index] = its;
+    }
+
+    static constexpr const char* header = "iterations_per_second," LATENCY_HEADER;
+
+    std::uint64_t operation_count() const {
+        return 2 * std::reduce(results.begin(), results.end());
+    }
+
+    template <typename T>
+    void output(T& stream) {
+        stream << std::reduce(results.begin(), results.end()) / test_time_seconds << ',';
+        latency_recorder::output_histograms(stream, latencies);
+    }
+};
+
+#endif // BENCHMARK_LATENCY_HPP_INCLUDED
@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_MANY_QUEUES_HPP_INCLUDED
+#define BENCHMARK_MANY_QUEUES_HPP_INCLUDED
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Stateless allocator keeping track of the total amount of bytes currently allocated through it.
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    static inline std::atomic<std::size_t> allocated_bytes = 0;
+
+    counting_allocator() = default;
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) { }
+
+    T* allocate(std::size_t n) {
+        counting_allocator<std::byte>::allocated_bytes += n * sizeof(T);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, std::size_t n) {
+        counting_allocator<std::byte>::allocated_bytes -= n * sizeof(T);
+        std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const counting_allocator<U>&) const { return true; }
+};
+
+struct benchmark_many_queues_result {
+    double bytes_per_queue;
+    // What the queue reports through allocated_size(), as a cross-check of the counted bytes (0 if not supported).
+    std::size_t reported_bytes_per_queue;
+    std::uint64_t operations_per_second;
+};
+
+// Creates queue_count independent queues and lets every thread alternate push and pop on randomly chosen ones.
+// FIFO must accept a counting_allocator<std::byte> as its last constructor argument.
+template <typename FIFO, typename... Args>
+benchmark_many_queues_result benchmark_many_queues(int num_threads, int queue_count, std::size_t queue_size, int test_time_seconds, Args... args) {
+    std::size_t allocated_before = counting_allocator<std::byte>::allocated_bytes;
+    std::vector<std::unique_ptr<FIFO>> queues;
+    queues.reserve(queue_count);
+    for (int i = 0; i < queue_count; i++) {
+        queues.push_back(std::make_unique<FIFO>(num_threads, queue_size, args..., counting_allocator<std::byte>{}));
+    }
+    double bytes_per_queue = sizeof(FIFO) + static_cast<double>(counting_allocator<std::byte>::allocated_bytes - allocated_before) / queue_count;
+    std::size_t reported_bytes_per_queue = 0;
+    if constexpr (requires (const FIFO& fifo) { fifo.allocated_size(); }) {
+        reported_bytes_per_queue = sizeof(FIFO) + queues.front()->allocated_size();
+    }
+
+    std::barrier a{ num_threads + 1 };
+    std::atomic_bool over = false;
+    std::vector<std::size_t> results(num_threads);
+    std::vector<std::jthread> threads(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+        threads[i] = std::jthread([&, i]() {
+            std::vector<typename FIFO::handle> handles;
+            handles.reserve(queue_count);
+            for (auto& queue : queues) {
+                handles.push_back(queue->get_handle());
+                // Keep every queue non-empty so pops do not degenerate to emptiness checks.
+                handles.back().push(i + 1);
+            }
+            std::minstd_rand rng{ static_cast<std::minstd_rand::result_type>(i + 1) };
+            std::uniform_int_distribution<int> dist{ 0, queue_count - 1 };
+            std::size_t its = 0;
+            a.arrive_and_wait();
+            while (!over) {
+                auto& handle = handles[dist(rng)];
+                handle.push(5);
+                handle.pop();
+                its++;
+            }
+            results[i] = its;
+        });
+    }
+
+    a.arrive_and_wait();
+    std::this_thread::sleep_for(std::chrono::seconds(test_time_seconds));
+    over = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return { bytes_per_queue, reported_bytes_per_queue, std::reduce(results.begin(), results.end()) / test_time_seconds };
+}
+
+#endif // BENCHMARK_MANY_QUEUES_HPP_INCLUDED
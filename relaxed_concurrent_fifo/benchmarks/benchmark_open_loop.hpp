@@ -0,0 +1,117 @@
+#ifndef BENCHMARK_OPEN_LOOP_HPP_INCLUDED
+#define BENCHMARK_OPEN_LOOP_HPP_INCLUDED
+
+#include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+struct benchmark_info_open_loop : public benchmark_info {
+    // Offered load in elements per second, summed over all producers.
+    double rate;
+    bool poisson;
+};
+
+// Open-loop load: Producers push at a fixed aggregate rate with Poisson or constant arrivals, consumers pop as fast as they can.
+// Elements carry their scheduled arrival time, so the end-to-end latency includes the time a producer fell behind its schedule
+// (avoiding coordinated omission) as well as the time spent queued. With a single thread, it produces and consumes alternately.
+// The backlog left when the run ends is drained afterwards and included in the latencies, as it holds the oldest elements;
+// it is reported separately and not counted towards the popped throughput.
+struct benchmark_open_loop : benchmark_base<> {
+    const benchmark_info_open_loop& info;
+    int producer_count;
+    std::chrono::steady_clock::time_point start;
+    std::vector<std::uint64_t> pushed;
+    std::vector<std::uint64_t> dropped;
+    std::vector<std::uint64_t> drained;
+    latency_recorder::histograms latencies;
+
+    benchmark_open_loop(const benchmark_info& info_base) :
+            info(reinterpret_cast<const benchmark_info_open_loop&>(info_base)),
+            producer_count(std::max(1, info.num_threads / 2)),
+            pushed(info.num_threads),
+            dropped(info.num_threads),
+            drained(info.num_threads),
+            latencies(info.num_threads) {
+        // Leave room for the backlog building up near saturation, pushes only fail once it exceeds this.
+        fifo_size = 1 << 20;
+    }
+
+    template <typename T>
+    void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
+        using namespace std::chrono;
+        bool is_producer = thread_index < producer_count;
+        bool is_consumer = thread_index >= producer_count || info.num_threads == 1;
+        latency_histogram& histogram = latencies[thread_index];
+
+        auto consume = [&]() {
+            if (auto popped = handle.pop(); popped.has_value()) {
+                auto now = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+                histogram.record(now - static_cast<std::int64_t>(*popped - 1));
+                return true;
+            }
+            return false;
+        };
+
+        arrival_schedule arrivals{ info.rate, producer_count, info.poisson, thread_index };
+        std::uint64_t local_pushed = 0;
+        std::uint64_t local_dropped = 0;
+
+        if (thread_index == 0) {
+            start = steady_clock::now();
+        }
+        a.arrive_and_wait();
+        while (!over.load(std::memory_order_relaxed)) {
+            if (is_producer) {
+                auto now = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+                if (now >= arrivals.next()) {
+                    // Timestamps are offset by one, as 0 can not be pushed.
+                    if (handle.push(static_cast<std::uint64_t>(arrivals.next()) + 1)) {
+                        local_pushed++;
+                    } else {
+                        local_dropped++;
+                    }
+                    arrivals.advance();
+                    continue;
+                }
+            }
+            if (is_consumer) {
+                consume();
+            }
+        }
+        std::uint64_t local_drained = 0;
+        if (is_consumer) {
+            while (consume()) {
+                local_drained++;
+            }
+        }
+        pushed[thread_index] = local_pushed;
+        dropped[thread_index] = local_dropped;
+        drained[thread_index] = local_drained;
+    }
+
+    static constexpr const char* header = "offered_per_second,pushed_per_second,popped_per_second,dropped,drained_at_end,"
+        "latency_p50_nanoseconds,latency_p90_nanoseconds,latency_p99_nanoseconds,latency_p999_nanoseconds,latency_max_nanoseconds";
+
+    template <typename T>
+    void output(T& stream) {
+        latency_histogram merged;
+        for (const latency_histogram& histogram : latencies) {
+            merged.merge(histogram);
+        }
+        auto total_drained = std::reduce(drained.begin(), drained.end());
+        stream << info.rate << ',' << std::reduce(pushed.begin(), pushed.end()) / info.test_time_seconds << ','
+            << (merged.count() - total_drained) / info.test_time_seconds << ',' << std::reduce(dropped.begin(), dropped.end()) << ','
+            << total_drained << ','
+            << merged.percentile(0.5) << ',' << merged.percentile(0.9) << ',' << merged.percentile(0.99) << ','
+            << merged.percentile(0.999) << ',' << merged.max();
+    }
+};
+
+#endif // BENCHMARK_OPEN_LOOP_HPP_INCLUDED
@@ -0,0 +1,136 @@
+#ifndef BENCHMARK_PARTITIONED_HPP_INCLUDED
+#define BENCHMARK_PARTITIONED_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Samples keys in [0, key_count) where the probability of key k is proportional to 1 / (k + 1)^s.
+class zipf_distribution {
+private:
+    std::vector<double> cdf;
+    std::uniform_real_distribution<double> uniform{ 0, 1 };
+
+public:
+    zipf_distribution(std::size_t key_count, double s) : cdf(key_count) {
+        double sum = 0;
+        for (std::size_t k = 0; k < key_count; k++) {
+            sum += 1 / std::pow(static_cast<double>(k + 1), s);
+            cdf[k] = sum;
+        }
+        for (auto& c : cdf) {
+            c /= sum;
+        }
+    }
+
+    template <typename RNG>
+    std::uint64_t operator()(RNG& rng) {
+        return std::min<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin(), cdf.size() - 1);
+    }
+};
+
+struct benchmark_partitioned_result {
+    std::uint64_t operations_per_second;
+    // Shards taken over per successful pop (0 for unpartitioned queues).
+    double takeover_ratio;
+    // Elements popped after a later element of the same key pushed by the same thread.
+    std::uint64_t order_violations;
+};
+
+// Every thread alternates pushing an element with a Zipf-distributed key and popping, on a half-filled queue.
+// Queues whose handles accept a key (like partitioned_fifo) receive it, all others just get the element.
+// Elements carry their key, producing thread and a per-thread sequence number, so every pop can check that no
+// later element of the same key and producer has been popped before it.
+template <typename FIFO, typename... Args>
+benchmark_partitioned_result benchmark_partitioned(int num_threads, int test_time_seconds, std::size_t size,
+    std::size_t key_count, double zipf_s, Args... args) {
+    if (num_threads > 256 || key_count >= (1 << 24)) {
+        throw std::runtime_error("Please use at most 256 threads and less than 2^24 keys for the partitioned benchmark");
+    }
+
+    FIFO fifo{ num_threads, size, args... };
+    zipf_distribution keys{ key_count, zipf_s };
+
+    // Highest sequence number popped so far per key and producer.
+    std::vector<std::atomic_uint32_t> last_popped(key_count * num_threads);
+
+    std::barrier a{ num_threads + 1 };
+    std::atomic_bool over = false;
+    std::vector<std::uint64_t> operations(num_threads);
+    std::vector<std::uint64_t> pops(num_threads);
+    std::vector<std::uint64_t> takeovers(num_threads);
+    std::vector<std::uint64_t> violations(num_threads);
+    std::vector<std::jthread> threads(num_threads);
+    for (int i = 0; i < num_threads; i++) {
+        threads[i] = std::jthread([&, i]() {
+            auto handle = fifo.get_handle();
+            auto local_keys = keys;
+            std::minstd_rand rng{ static_cast<std::minstd_rand::result_type>(i + 1) };
+            std::uint32_t next_seq = 1;
+            auto push = [&]() {
+                auto key = local_keys(rng);
+                std::uint64_t value = ((key + 1) << 40) | (static_cast<std::uint64_t>(i) << 32) | next_seq++;
+                if constexpr (requires { handle.push(key, value); }) {
+                    return handle.push(key, value);
+                } else {
+                    return handle.push(value);
+                }
+            };
+            std::uint64_t violated = 0;
+            auto check = [&](std::uint64_t value) {
+                auto seq = static_cast<std::uint32_t>(value);
+                auto& last = last_popped[((value >> 40) - 1) * num_threads + ((value >> 32) & 0xff)];
+                auto prev = last.load(std::memory_order_relaxed);
+                while (prev < seq && !last.compare_exchange_weak(prev, seq, std::memory_order_relaxed)) { }
+                if (prev > seq) {
+                    violated++;
+                }
+            };
+
+            for (std::size_t j = 0; j < size / 2 / num_threads; j++) {
+                push();
+            }
+            std::uint64_t its = 0;
+            std::uint64_t popped = 0;
+            a.arrive_and_wait();
+            while (!over.load(std::memory_order_relaxed)) {
+                if (push()) {
+                    its++;
+                }
+                if (auto value = handle.pop(); value.has_value()) {
+                    check(*value);
+                    its++;
+                    popped++;
+                }
+            }
+            operations[i] = its;
+            pops[i] = popped;
+            violations[i] = violated;
+            if constexpr (requires { handle.takeovers(); }) {
+                takeovers[i] = handle.takeovers();
+            }
+        });
+    }
+
+    a.arrive_and_wait();
+    std::this_thread::sleep_for(std::chrono::seconds(test_time_seconds));
+    over = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto total_pops = std::reduce(pops.begin(), pops.end());
+    return { std::reduce(operations.begin(), operations.end()) / test_time_seconds,
+        total_pops == 0 ? 0 : static_cast<double>(std::reduce(takeovers.begin(), takeovers.end())) / total_pops,
+        std::reduce(violations.begin(), violations.end()) };
+}
+
+#endif // BENCHMARK_PARTITIONED_HPP_INCLUDED
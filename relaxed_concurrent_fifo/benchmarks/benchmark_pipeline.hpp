@@ -0,0 +1,161 @@
+#ifndef BENCHMARK_PIPELINE_HPP_INCLUDED
+#define BENCHMARK_PIPELINE_HPP_INCLUDED
+
+#include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+struct benchmark_info_pipeline : public benchmark_info {
+    // Threads per stage, num_threads has to be their sum.
+    std::vector<int> stage_threads;
+    // Busy-waiting per item in every stage.
+    std::uint64_t work_nanos;
+    // Items per second created by the whole first stage, with Poisson arrivals; 0 for as fast as possible.
+    double source_rate;
+};
+
+// Chain of stages connected by one queue each: The first stage creates items, every further stage pops from the queue
+// before it, works on the item and pushes it on to the queue after it, except for the last one, which only pops.
+// Items carry their creation time, the last stage records their end-to-end latency.
+// With a source rate, items are created on an arrival_schedule and carry their scheduled arrival time, like in
+// benchmark_open_loop. Without one, the source runs saturated, filling the first queue until backpressure stops it,
+// so the latency mostly reflects draining that queue and grows with fifo_size.
+// Queue depths are derived from the per-thread push and pop counts of the adjacent stages.
+struct benchmark_pipeline : benchmark_base<> {
+    static constexpr std::chrono::milliseconds SAMPLE_INTERVAL{ 10 };
+
+    const benchmark_info_pipeline& info;
+    std::vector<int> stage_of_thread;
+    std::chrono::steady_clock::time_point start;
+
+    std::vector<cache_aligned_t<std::atomic_uint64_t>> pushed;
+    std::vector<cache_aligned_t<std::atomic_uint64_t>> popped;
+    latency_recorder::histograms latencies;
+
+    // Per queue.
+    std::vector<std::uint64_t> depth_sums;
+    std::vector<std::int64_t> depth_maxima;
+    std::uint64_t sample_count = 0;
+
+    benchmark_pipeline(const benchmark_info& info_base) :
+            info(reinterpret_cast<const benchmark_info_pipeline&>(info_base)),
+            pushed(info.num_threads),
+            popped(info.num_threads),
+            latencies(info.num_threads),
+            depth_sums(queue_count()),
+            depth_maxima(queue_count()) {
+        for (int stage = 0; stage < static_cast<int>(info.stage_threads.size()); stage++) {
+            stage_of_thread.insert(stage_of_thread.end(), info.stage_threads[stage], stage);
+        }
+        // Queues only need to hold the items in flight between two stages.
+        fifo_size = 1 << 16;
+    }
+
+    std::size_t queue_count() const {
+        return info.stage_threads.size() - 1;
+    }
+
+    template <typename T>
+    void per_thread(int thread_index, std::vector<typename T::handle>& handles, std::barrier<>& a, std::atomic_bool& over) {
+        using namespace std::chrono;
+        int stage = stage_of_thread[thread_index];
+        bool is_source = stage == 0;
+        bool is_sink = stage == static_cast<int>(queue_count());
+        latency_histogram& histogram = latencies[thread_index];
+        std::uint64_t local_pushed = 0;
+        std::uint64_t local_popped = 0;
+        bool rate_limited = is_source && info.source_rate > 0;
+        arrival_schedule arrivals{ rate_limited ? info.source_rate : 1, info.stage_threads[0], true, thread_index };
+
+        if (thread_index == 0) {
+            start = steady_clock::now();
+        }
+        a.arrive_and_wait();
+        while (!over.load(std::memory_order_relaxed)) {
+            std::uint64_t item;
+            if (rate_limited) {
+                if (duration_cast<nanoseconds>(steady_clock::now() - start).count() < arrivals.next()) {
+                    continue;
+                }
+                // Timestamps are offset by one, as 0 can not be pushed.
+                item = static_cast<std::uint64_t>(arrivals.next()) + 1;
+                arrivals.advance();
+            } else if (is_source) {
+                item = duration_cast<nanoseconds>(steady_clock::now() - start).count() + 1;
+            } else {
+                auto popped_item = handles[stage - 1].pop();
+                if (!popped_item.has_value()) {
+                    continue;
+                }
+                item = *popped_item;
+                popped[thread_index]->store(++local_popped, std::memory_order_relaxed);
+            }
+
+            busy_wait(info.work_nanos);
+
+            if (is_sink) {
+                histogram.record(duration_cast<nanoseconds>(steady_clock::now() - start).count() + 1 - item);
+            } else {
+                // Full queues apply backpressure to the stage before them.
+                while (!handles[stage].push(item)) {
+                    if (over.load(std::memory_order_relaxed)) {
+                        return;
+                    }
+                }
+                pushed[thread_index]->store(++local_pushed, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void sample() {
+        std::vector<std::int64_t> depths(queue_count());
+        for (int i = 0; i < info.num_threads; i++) {
+            int stage = stage_of_thread[i];
+            if (stage < static_cast<int>(queue_count())) {
+                depths[stage] += pushed[i]->load(std::memory_order_relaxed);
+            }
+            if (stage > 0) {
+                depths[stage - 1] -= popped[i]->load(std::memory_order_relaxed);
+            }
+        }
+        for (std::size_t q = 0; q < depths.size(); q++) {
+            // Counters are read one after another, so a depth may briefly appear negative.
+            depths[q] = std::max<std::int64_t>(depths[q], 0);
+            depth_sums[q] += depths[q];
+            depth_maxima[q] = std::max(depth_maxima[q], depths[q]);
+        }
+        sample_count++;
+    }
+
+    static constexpr const char* header = "stages,source_rate,items_per_second,latency_p50_nanoseconds,latency_p90_nanoseconds,latency_p99_nanoseconds,"
+        "latency_p999_nanoseconds,latency_max_nanoseconds,mean_queue_depths,max_queue_depths";
+
+    template <typename T>
+    void output(T& stream) {
+        latency_histogram merged;
+        for (const latency_histogram& histogram : latencies) {
+            merged.merge(histogram);
+        }
+        auto join = [&](const auto& values, auto transform) {
+            for (std::size_t i = 0; i < values.size(); i++) {
+                stream << (i == 0 ? "" : ";") << transform(values[i]);
+            }
+        };
+        join(info.stage_threads, [](int threads) { return threads; });
+        stream << ',' << info.source_rate << ',' << merged.count() / info.test_time_seconds << ',' << merged.percentile(0.5) << ',' << merged.percentile(0.9) << ','
+            << merged.percentile(0.99) << ',' << merged.percentile(0.999) << ',' << merged.max() << ',';
+        join(depth_sums, [&](std::uint64_t sum) { return sample_count == 0 ? 0. : static_cast<double>(sum) / sample_count; });
+        stream << ',';
+        join(depth_maxima, [](std::int64_t max) { return max; });
+    }
+};
+
+#endif // BENCHMARK_PIPELINE_HPP_INCLUDED
@@ -0,0 +1,151 @@
+#ifndef BENCHMARK_PQ_QUALITY_HPP_INCLUDED
+#define BENCHMARK_PQ_QUALITY_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark_base.hpp"
+#include "benchmark_pq_throughput.hpp"
+#include "../replay_tree.hpp"
+
+// Rank error of a priority queue: For every pop, the amount of elements with a smaller value
+// (priority, then sequence number) present in the queue at that time.
+// Like benchmark_pq_throughput, the queue has to be run without the provider's prefill.
+struct benchmark_pq_quality : benchmark_base<false, false, false> {
+private:
+    std::atomic_uint64_t chunks_done = 0;
+    std::atomic_uint64_t failed_pushes = 0;
+
+    struct event {
+        std::uint64_t time;
+        std::uint64_t value;
+    };
+
+    std::vector<std::vector<event>> pushes;
+    std::vector<std::vector<event>> pops;
+    std::size_t prefill_per_thread;
+    int num_threads;
+
+    static std::uint64_t now() {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    template <typename T>
+    static void output_stats(T& stream, const std::vector<std::uint64_t>& data) {
+        double avg = std::reduce(data.begin(), data.end()) / static_cast<double>(data.size());
+        double std = std::sqrt(std::accumulate(data.begin(), data.end(), 0., [avg](double sum, std::uint64_t value) {
+            return sum + (value - avg) * (value - avg);
+        }) / data.size());
+        stream << avg << ',' << std << ',' << *std::max_element(data.begin(), data.end());
+    }
+
+public:
+    static constexpr int CHUNK_SIZE = 5'000;
+    static constexpr int CHUNK_COUNT = 1'000;
+
+    benchmark_pq_quality(const benchmark_info& info) : pushes(info.num_threads), pops(info.num_threads),
+        prefill_per_thread(fifo_size / 2 / info.num_threads), num_threads(info.num_threads) {
+        // Elements have to stay unique even if a single thread ends up processing all chunks.
+        if (prefill_per_thread + static_cast<std::uint64_t>(CHUNK_SIZE) * (CHUNK_COUNT + 1) >= pq_element_generator::sequence_capacity(info.num_threads)) {
+            throw std::runtime_error("Too many threads for unique priority queue elements");
+        }
+        std::size_t size_per_thread = CHUNK_SIZE * CHUNK_COUNT / info.num_threads * 2;
+        for (auto& vec : pushes) {
+            vec.reserve(size_per_thread + prefill_per_thread);
+        }
+        for (auto& vec : pops) {
+            vec.reserve(size_per_thread);
+        }
+    }
+
+    benchmark_pq_quality(const benchmark_pq_quality& other) : failed_pushes(other.failed_pushes.load()), pushes(other.pushes), pops(other.pops),
+        prefill_per_thread(other.prefill_per_thread), num_threads(other.num_threads) { }
+    benchmark_pq_quality& operator=(const benchmark_pq_quality& other) {
+        pushes = other.pushes;
+        pops = other.pops;
+        prefill_per_thread = other.prefill_per_thread;
+        num_threads = other.num_threads;
+        failed_pushes = other.failed_pushes.load();
+        return *this;
+    }
+
+    template <typename T>
+    void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a) {
+        pq_element_generator next{ thread_index, num_threads };
+        std::uint64_t failed = 0;
+        // Only successful pushes are recorded, a failed one's element never becomes part of the queue.
+        // The time is taken before the push, so that it always precedes the element's pop.
+        auto push = [&]() {
+            auto value = next();
+            auto time = now();
+            if (handle.push(value)) {
+                pushes[thread_index].push_back({ time, value });
+            } else {
+                failed++;
+            }
+        };
+        for (std::size_t i = 0; i < prefill_per_thread; i++) {
+            push();
+        }
+        a.arrive_and_wait();
+        do {
+            for (int i = 0; i < CHUNK_SIZE; i++) {
+                push();
+                if (auto popped = handle.pop(); popped.has_value()) {
+                    pops[thread_index].push_back({ now(), popped.value() });
+                }
+            }
+        } while (chunks_done.fetch_add(1) < CHUNK_COUNT);
+        failed_pushes.fetch_add(failed, std::memory_order_relaxed);
+    }
+
+    static constexpr const char* header = "rank_error_avg,rank_error_std,rank_error_max,delay_avg,delay_std,delay_max,failed_pushes";
+
+    template <typename T>
+    void output(T& stream) {
+        auto flatten = [](const std::vector<std::vector<event>>& per_thread) {
+            std::vector<event> all;
+            for (const auto& events : per_thread) {
+                all.insert(all.end(), events.begin(), events.end());
+            }
+            std::sort(std::execution::par_unseq, all.begin(), all.end(), [](const auto& a, const auto& b) { return a.time < b.time; });
+            return all;
+        };
+        auto all_pushes = flatten(pushes);
+        auto all_pops = flatten(pops);
+
+        std::vector<std::uint64_t> rank_errors;
+        std::vector<std::uint64_t> delays;
+        rank_errors.reserve(all_pops.size());
+        delays.reserve(all_pops.size());
+        struct id {
+            static std::uint64_t const& get(std::uint64_t const& value) { return value; }
+        };
+        ReplayTree<std::uint64_t, std::uint64_t, id> replay_tree{};
+        auto push_it = all_pushes.begin();
+        for (const auto& pop : all_pops) {
+            while (push_it != all_pushes.end() && push_it->time <= pop.time) {
+                replay_tree.insert(push_it->value);
+                ++push_it;
+            }
+            auto [success, rank_error, delay] = replay_tree.erase_val(pop.value);
+            assert(success);
+            rank_errors.emplace_back(rank_error);
+            delays.emplace_back(delay);
+        }
+
+        output_stats(stream, rank_errors);
+        stream << ',';
+        output_stats(stream, delays);
+        stream << ',' << failed_pushes;
+    }
+};
+
+#endif // BENCHMARK_PQ_QUALITY_HPP_INCLUDED
@@ -0,0 +1,86 @@
+#ifndef BENCHMARK_PQ_THROUGHPUT_HPP_INCLUDED
+#define BENCHMARK_PQ_THROUGHPUT_HPP_INCLUDED
+
+#include <algorithm>
+#include <barrier>
+#include <bit>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "benchmark_base.hpp"
+
+// Element layout shared by the priority queue benchmarks: The priority in the upper 32 bits and in the lower ones
+// a per-thread sequence number followed by the thread index, so that elements are unique across threads.
+// The thread index takes as many bits as the thread count requires, the sequence number gets the rest and wraps
+// after sequence_capacity(thread_count) elements.
+struct pq_element_generator {
+    static constexpr std::uint64_t PRIORITY_COUNT = 1 << 16;
+    static constexpr int MAX_THREAD_BITS = 16;
+
+    std::minstd_rand rng;
+    std::uniform_int_distribution<std::uint64_t> priorities{ 0, PRIORITY_COUNT - 1 };
+    std::uint64_t thread_index;
+    int thread_bits;
+    std::uint64_t seq = 0;
+
+    static int thread_bits_for(int thread_count) {
+        int bits = std::bit_width(static_cast<unsigned>(std::max(thread_count, 1) - 1));
+        if (bits > MAX_THREAD_BITS) {
+            throw std::runtime_error("Please use at most 65536 threads for the priority queue benchmarks");
+        }
+        return bits;
+    }
+
+    static std::uint64_t sequence_capacity(int thread_count) {
+        return 1ull << (32 - thread_bits_for(thread_count));
+    }
+
+    pq_element_generator(int thread_index, int thread_count) : rng(thread_index + 1), thread_index(thread_index),
+        thread_bits(thread_bits_for(thread_count)) { }
+
+    std::uint64_t operator()() {
+        seq++;
+        std::uint64_t low = ((seq << thread_bits) | thread_index) & 0xffff'ffff;
+        return (priorities(rng) << 32) | low;
+    }
+};
+
+// Alternating push/pop with uniformly random priorities on a half-filled priority queue.
+// The queue has to be run without the provider's prefill (whose elements all have priority 0), it prefills itself.
+// Sequence numbers may wrap here, which only affects the order among elements of equal priority.
+struct benchmark_pq_throughput : benchmark_base<> {
+    std::vector<std::size_t> results;
+    std::size_t test_time_seconds;
+    std::size_t prefill_per_thread;
+    int num_threads;
+
+    benchmark_pq_throughput(const benchmark_info& info) : results(info.num_threads), test_time_seconds(info.test_time_seconds),
+        prefill_per_thread(fifo_size / 2 / info.num_threads), num_threads(info.num_threads) { }
+
+    template <typename T>
+    void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
+        pq_element_generator next{ thread_index, num_threads };
+        for (std::size_t i = 0; i < prefill_per_thread; i++) {
+            handle.push(next());
+        }
+        std::size_t its = 0;
+        a.arrive_and_wait();
+        while (!over) {
+            handle.push(next());
+            handle.pop();
+            its++;
+        }
+        results[thread_index] = its;
+    }
+
+    static constexpr const char* header = "iterations_per_second";
+
+    template <typename T>
+    void output(T& stream) {
+        stream << std::reduce(results.begin(), results.end()) / test_time_seconds;
+    }
+};
+
+#endif // BENCHMARK_PQ_THROUGHPUT_HPP_INCLUDED
@@ -19,29 +19,37 @@ struct benchmark_prodcon : benchmark_default {
     template <typename T>
     void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
         std::size_t its = 0;
-        a.arrive_and_wait();
+        auto sample = get_sampler(thread_index);
+        start_measurement(a);
         while (!over) {
             if (thread_index < thread_switch) {
-                if (handle.push(5)) {
+                if (sample([&]() { return handle.push(5); })) {
                     its++;
+                    record_progress(thread_index, its);
                 }
             } else {
-                if (handle.pop().has_value()) {
+                if (sample([&]() { return handle.pop(); }).has_value()) {
                     its++;
+                    record_progress(thread_index, its);
                 }
             }
         }
         results[thread_index] = its;
     }
 
-    static constexpr const char* header = "operations_per_second";
+    static constexpr const char* header = "operations_per_second," THREAD_DISTRIBUTION_HEADER;
+
+    std::uint64_t operation_count() const {
+        return std::reduce(results.begin(), results.end());
+    }
 
     template <typename T>
     void output(T& stream) {
         stream << std::min(
             std::reduce(results.begin(), results.begin() + thread_switch),
             std::reduce(results.begin() + thread_switch, results.end()))
-        / test_time_seconds;
+        / test_time_seconds << ',';
+        thread_distribution::output(stream, results);
     }
 };
 
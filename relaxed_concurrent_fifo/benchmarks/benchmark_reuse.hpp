@@ -0,0 +1,59 @@
+#ifndef BENCHMARK_REUSE_HPP_INCLUDED
+#define BENCHMARK_REUSE_HPP_INCLUDED
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+// Lifecycle of a short-lived queue: A batch is pushed, half of it is popped, then the queue is discarded.
+// Compares constructing a new queue for every batch against clearing and reusing a single one.
+struct benchmark_reuse_result {
+    double reconstruct_nanos;
+    double clear_nanos;
+};
+
+template <typename FIFO>
+void benchmark_reuse_batch(typename FIFO::handle& handle, std::size_t elements) {
+    for (std::size_t i = 0; i < elements; i++) {
+        handle.push(i + 1);
+    }
+    for (std::size_t i = 0; i < elements / 2; i++) {
+        handle.pop();
+    }
+}
+
+template <typename FIFO, typename... Args>
+benchmark_reuse_result benchmark_reuse(std::size_t size, int test_time_seconds, Args... args) {
+    // Half of the time for each variant.
+    auto duration = std::chrono::milliseconds(test_time_seconds * 500);
+    std::size_t elements = size / 2;
+
+    std::size_t reconstruct_cycles = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto now = start;
+    while (now - start < duration) {
+        auto fifo = std::make_unique<FIFO>(1, size, args...);
+        auto handle = fifo->get_handle();
+        benchmark_reuse_batch<FIFO>(handle, elements);
+        reconstruct_cycles++;
+        now = std::chrono::steady_clock::now();
+    }
+    double reconstruct_nanos = std::chrono::duration<double, std::nano>(now - start).count() / reconstruct_cycles;
+
+    std::size_t clear_cycles = 0;
+    auto fifo = std::make_unique<FIFO>(1, size, args...);
+    auto handle = fifo->get_handle();
+    start = now = std::chrono::steady_clock::now();
+    while (now - start < duration) {
+        fifo->clear();
+        benchmark_reuse_batch<FIFO>(handle, elements);
+        clear_cycles++;
+        now = std::chrono::steady_clock::now();
+    }
+    double clear_nanos = std::chrono::duration<double, std::nano>(now - start).count() / clear_cycles;
+
+    return { reconstruct_nanos, clear_nanos };
+}
+
+#endif // BENCHMARK_REUSE_HPP_INCLUDED
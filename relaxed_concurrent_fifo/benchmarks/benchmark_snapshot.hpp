@@ -0,0 +1,62 @@
+#ifndef BENCHMARK_SNAPSHOT_HPP_INCLUDED
+#define BENCHMARK_SNAPSHOT_HPP_INCLUDED
+
+#ifdef __unix__
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Measures writing a full queue to a file with block_based_queue::snapshot and restoring it into a new queue
+// with block_based_queue::load. The timings include opening the file (and syncing it when saving), but not the queue construction.
+struct benchmark_snapshot_result {
+    std::size_t elements;
+    std::size_t file_bytes;
+    std::uint64_t save_nanos;
+    std::uint64_t load_nanos;
+};
+
+template <typename FIFO, typename... Args>
+benchmark_snapshot_result benchmark_snapshot(int num_threads, std::size_t elements, const std::string& path, Args... args) {
+    benchmark_snapshot_result result{ 0, 0, 0, 0 };
+
+    {
+        FIFO fifo{ num_threads, elements * 2, args... };
+        fifo.assign(std::views::iota(static_cast<std::uint64_t>(1), elements + 1), num_threads);
+        auto start = std::chrono::steady_clock::now();
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create snapshot file " + path);
+        }
+        fifo.snapshot(fd);
+        fsync(fd);
+        result.file_bytes = lseek(fd, 0, SEEK_CUR);
+        close(fd);
+        result.save_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    {
+        FIFO fifo{ num_threads, elements * 2, args... };
+        auto start = std::chrono::steady_clock::now();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open snapshot file " + path);
+        }
+        result.elements = fifo.load(fd, num_threads);
+        close(fd);
+        result.load_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::remove(path.c_str());
+    return result;
+}
+
+#endif // __unix__
+
+#endif // BENCHMARK_SNAPSHOT_HPP_INCLUDED
@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_SYNTHETIC_HPP_INCLUDED
+#define BENCHMARK_SYNTHETIC_HPP_INCLUDED
+
+#include "benchmark_base.hpp"
+#include "latency_histogram.hpp"
+#include "thread_distribution.hpp"
+
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+struct benchmark_info_synthetic : public benchmark_info {
+    // Probability of a burst of mixed threads being pops.
+    double pop_ratio;
+    // Busy-waiting after every operation, simulating work on the element.
+    std::uint64_t think_nanos;
+    // Consecutive operations of the same kind.
+    int burst;
+    // Role of thread i is roles[i % roles.size()]: 'p' only pushes, 'c' only pops, 'm' mixes according to pop_ratio.
+    std::string roles;
+};
+
+struct benchmark_synthetic : benchmark_base<>, latency_recorder {
+    const benchmark_info_synthetic& info;
+    std::vector<std::uint64_t> results;
+    std::vector<std::uint64_t> pushes;
+    std::vector<std::uint64_t> pops;
+    std::vector<std::uint64_t> failures;
+
+    benchmark_synthetic(const benchmark_info& info_base) :
+            latency_recorder(info_base.num_threads),
+            info(reinterpret_cast<const benchmark_info_synthetic&>(info_base)),
+            results(info.num_threads),
+            pushes(info.num_threads),
+            pops(info.num_threads),
+            failures(info.num_threads) { }
+
+    template <typename T>
+    void per_thread(int thread_index, typename T::handle& handle, std::barrier<>& a, std::atomic_bool& over) {
+        char role = info.roles.empty() ? 'm' : info.roles[thread_index % info.roles.size()];
+        std::minstd_rand rng{ static_cast<std::minstd_rand::result_type>(thread_index + 1) };
+        std::bernoulli_distribution is_pop{ info.pop_ratio };
+        auto sample = get_sampler(thread_index);
+        std::uint64_t local_pushes = 0;
+        std::uint64_t local_pops = 0;
+        std::uint64_t local_failures = 0;
+        start_measurement(a);
+        while (!over) {
+            bool pop = role == 'c' || (role == 'm' && is_pop(rng));
+            for (int i = 0; i < info.burst && !over; i++) {
+                if (pop) {
+                    if (sample([&]() { return handle.pop(); }).has_value()) {
+                        local_pops++;
+                    } else {
+                        local_failures++;
+                    }
+                } else {
+                    if (sample([&]() { return handle.push(thread_index + 1); })) {
+                        local_pushes++;
+                    } else {
+                        local_failures++;
+                    }
+                }
+                record_progress(thread_index, local_pushes + local_pops);
+                busy_wait(info.think_nanos);
+            }
+        }
+        results[thread_index] = local_pushes + local_pops;
+        pushes[thread_index] = local_pushes;
+        pops[thread_index] = local_pops;
+        failures[thread_index] = local_failures;
+    }
+
+    static constexpr const char* header = "operations_per_second,pushes_per_second,pops_per_second,failed_operations," THREAD_DISTRIBUTION_HEADER;
+
+    const std::vector<std::uint64_t>& thread_operations() const {
+        return results;
+    }
+
+    std::uint64_t operation_count() const {
+        return std::reduce(results.begin(), results.end());
+    }
+
+    template <typename T>
+    void output(T& stream) {
+        stream << operation_count() / info.test_time_seconds << ','
+            << std::reduce(pushes.begin(), pushes.end()) / info.test_time_seconds << ','
+            << std::reduce(pops.begin(), pops.end()) / info.test_time_seconds << ','
+            << std::reduce(failures.begin(), failures.end()) << ',';
+        thread_distribution::output(stream, results);
+    }
+};
+
+#endif // BENCHMARK_SYNTHETIC_HPP_INCLUDED
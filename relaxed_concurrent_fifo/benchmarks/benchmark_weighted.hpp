@@ -0,0 +1,130 @@
+#ifndef BENCHMARK_WEIGHTED_HPP_INCLUDED
+#define BENCHMARK_WEIGHTED_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../weighted_consumer.h"
+
+// Baseline for weighted_consumer: Every pop polls the queues in turn, starting after the last one it served, ignoring weights.
+template <typename FIFO, typename T = std::uint64_t>
+class round_robin_consumer {
+private:
+    std::vector<FIFO*> queues;
+
+public:
+    round_robin_consumer(std::vector<FIFO*> queues, const std::vector<std::uint64_t>&) : queues(std::move(queues)) { }
+
+    class handle {
+    private:
+        std::vector<typename FIFO::handle> queue_handles;
+        std::size_t current = 0;
+
+        handle(round_robin_consumer& consumer) {
+            queue_handles.reserve(consumer.queues.size());
+            for (auto* queue : consumer.queues) {
+                queue_handles.push_back(queue->get_handle());
+            }
+        }
+
+        friend round_robin_consumer;
+
+    public:
+        bool push(std::size_t index, T t) {
+            return queue_handles[index].push(std::move(t));
+        }
+
+        std::optional<T> pop() {
+            for (std::size_t i = 0; i < queue_handles.size(); i++) {
+                current = (current + 1) % queue_handles.size();
+                if (auto ret = queue_handles[current].pop(); ret.has_value()) {
+                    return ret;
+                }
+            }
+            return std::nullopt;
+        }
+    };
+
+    handle get_handle() { return handle(*this); }
+};
+
+struct benchmark_weighted_result {
+    std::uint64_t pops_per_second;
+    // Largest deviation of a queue's share of pops from its weight's share among the active queues, relative to the latter.
+    double max_share_deviation;
+};
+
+// The first active_count of the queues are kept backlogged by num_threads / 2 producers (at least one),
+// while the remaining threads consume through CONSUMER. Elements carry the index of their queue.
+template <template <typename, typename> typename CONSUMER, typename FIFO, typename... Args>
+benchmark_weighted_result benchmark_weighted(int num_threads, int test_time_seconds, std::size_t queue_size,
+    const std::vector<std::uint64_t>& weights, std::size_t active_count, Args... args) {
+    int producer_count = std::max(1, num_threads / 2);
+    int consumer_count = std::max(1, num_threads - producer_count);
+
+    std::vector<std::unique_ptr<FIFO>> queues;
+    std::vector<FIFO*> queue_ptrs;
+    for (std::size_t i = 0; i < weights.size(); i++) {
+        queues.push_back(std::make_unique<FIFO>(producer_count + consumer_count, queue_size, args...));
+        queue_ptrs.push_back(queues.back().get());
+    }
+    CONSUMER<FIFO, std::uint64_t> consumer{ queue_ptrs, weights };
+
+    std::barrier a{ producer_count + consumer_count + 1 };
+    std::atomic_bool over = false;
+    std::vector<std::vector<std::uint64_t>> served(consumer_count, std::vector<std::uint64_t>(weights.size()));
+    std::vector<std::jthread> threads;
+    for (int i = 0; i < producer_count; i++) {
+        threads.emplace_back([&, i]() {
+            auto handle = consumer.get_handle();
+            std::uint64_t seq = 0;
+            a.arrive_and_wait();
+            while (!over.load(std::memory_order_relaxed)) {
+                // Full queues simply reject the push, which keeps them backlogged.
+                std::size_t queue = (seq + i) % active_count;
+                handle.push(queue, (static_cast<std::uint64_t>(queue) << 32) | ((++seq) & 0xffff'ffff));
+            }
+        });
+    }
+    for (int i = 0; i < consumer_count; i++) {
+        threads.emplace_back([&, i]() {
+            auto handle = consumer.get_handle();
+            a.arrive_and_wait();
+            while (!over.load(std::memory_order_relaxed)) {
+                if (auto popped = handle.pop(); popped.has_value()) {
+                    served[i][*popped >> 32]++;
+                }
+            }
+        });
+    }
+
+    a.arrive_and_wait();
+    std::this_thread::sleep_for(std::chrono::seconds(test_time_seconds));
+    over = true;
+    threads.clear();
+
+    std::vector<std::uint64_t> per_queue(weights.size());
+    for (const auto& counts : served) {
+        std::transform(per_queue.begin(), per_queue.end(), counts.begin(), per_queue.begin(), std::plus<>{});
+    }
+    double total_pops = std::reduce(per_queue.begin(), per_queue.end());
+    double total_weight = std::reduce(weights.begin(), weights.begin() + active_count);
+    double max_deviation = 0;
+    for (std::size_t i = 0; i < active_count; i++) {
+        double expected = weights[i] / total_weight;
+        double actual = total_pops == 0 ? 0 : per_queue[i] / total_pops;
+        max_deviation = std::max(max_deviation, std::abs(actual - expected) / expected);
+    }
+    return { static_cast<std::uint64_t>(total_pops) / test_time_seconds, max_deviation };
+}
+
+#endif // BENCHMARK_WEIGHTED_HPP_INCLUDED
@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_WORK_STEALING_HPP_INCLUDED
+#define BENCHMARK_WORK_STEALING_HPP_INCLUDED
+
+#include "benchmark_fork_join.hpp"
+#include "benchmark_graph.hpp"
+
+#include <memory>
+
+#include "../work_stealing_pool.h"
+
+// The fork-join and BFS workloads run on a work_stealing_pool, with the benchmarked queue only serving as the pool's
+// shared injection and overflow queue. Counters, validation and output are those of the global-queue variants.
+
+// Small enough that the shared queue still sees overflow traffic on wide task trees.
+constexpr std::size_t WORK_STEALING_LOCAL_CAPACITY = 1 << 10;
+
+struct benchmark_fork_join_pool : benchmark_fork_join {
+    // The benchmark is returned by value, the pool is not movable.
+    std::unique_ptr<work_stealing_pool<>> pool;
+
+    benchmark_fork_join_pool(const benchmark_info& info_base) :
+            benchmark_fork_join(info_base),
+            pool(std::make_unique<work_stealing_pool<>>(info.num_threads, WORK_STEALING_LOCAL_CAPACITY)) { }
+
+    template <typename FIFO>
+    void per_thread(int thread_index, typename FIFO::handle& handle, std::barrier<>& a) {
+        counter c;
+        auto worker = pool->get_worker(thread_index, handle);
+        auto spawn = [&](std::uint64_t child) {
+            worker.push(child);
+            ++c.pushed;
+        };
+        if (thread_index == 0) {
+            worker.inject(fork_join::root_task(info.workload, info.size));
+            ++c.pushed;
+        }
+        a.arrive_and_wait();
+        pool->work(worker, [&](std::uint64_t task, auto&) {
+            c.result += fork_join::process(info.workload, info.size, task, spawn);
+            ++c.processed;
+        });
+        c.err = worker.failed();
+        counters[thread_index] = c;
+    }
+};
+
+// Processes local nodes in FIFO order, LIFO order would degenerate into a label-correcting depth-first search.
+struct benchmark_bfs_pool : benchmark_bfs {
+    std::unique_ptr<work_stealing_pool<>> pool;
+
+    benchmark_bfs_pool(const benchmark_info& info_base) :
+            benchmark_bfs(info_base),
+            pool(std::make_unique<work_stealing_pool<>>(info.num_threads, WORK_STEALING_LOCAL_CAPACITY, local_order::FIFO)) { }
+
+    template <typename FIFO>
+    void per_thread(int thread_index, typename FIFO::handle& handle, std::barrier<>& a) {
+        Counter counter;
+        auto worker = pool->get_worker(thread_index, handle);
+        if (thread_index == 0) {
+            // We can't push 0 to the queues!
+            distances[0].value = 1;
+            worker.inject(1ull << 32);
+            ++counter.pushed_nodes;
+        }
+        a.arrive_and_wait();
+        pool->work(worker, [&](std::uint64_t node, auto& w) {
+            process_node(node, w, counter);
+        });
+        counter.err |= worker.failed();
+        counters[thread_index] = counter;
+    }
+};
+
+#endif // BENCHMARK_WORK_STEALING_HPP_INCLUDED
@@ -0,0 +1,141 @@
+#ifndef CPU_TOPOLOGY_HPP_INCLUDED
+#define CPU_TOPOLOGY_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+struct cpu_info {
+    int cpu;
+    int package;
+    int core;
+    // Position among the hardware threads of its core, by CPU number.
+    int smt_index;
+};
+
+enum class pinning_strategy {
+    // Logical CPU numbering of the operating system.
+    LOGICAL,
+    // Fill core after core, hardware threads of a core next to each other.
+    COMPACT,
+    // Round robin over packages, within each package one thread per core first.
+    SCATTER,
+    // One thread on every core first, then the second hardware thread of every core and so on.
+    CORES_THEN_SMT,
+    // CPU list given by the user.
+    LIST,
+};
+
+inline const char* pinning_strategy_name(pinning_strategy strategy) {
+    switch (strategy) {
+    case pinning_strategy::LOGICAL: return "logical";
+    case pinning_strategy::COMPACT: return "compact";
+    case pinning_strategy::SCATTER: return "scatter";
+    case pinning_strategy::CORES_THEN_SMT: return "cores";
+    case pinning_strategy::LIST: return "list";
+    }
+    return "unknown";
+}
+
+inline bool parse_pinning_strategy(const char* name, pinning_strategy& strategy) {
+    for (auto s : { pinning_strategy::LOGICAL, pinning_strategy::COMPACT, pinning_strategy::SCATTER, pinning_strategy::CORES_THEN_SMT }) {
+        if (std::strcmp(name, pinning_strategy_name(s)) == 0) {
+            strategy = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses CPU lists like "0-3,8,10-11" as found in sysfs.
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream{ list };
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") {
+            continue;
+        }
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Online CPUs with their package and core as reported by /sys/devices/system/cpu.
+// Where that is not available, every logical CPU is assumed to be its own core in a single package.
+inline std::vector<cpu_info> read_cpu_topology() {
+    const std::string base = "/sys/devices/system/cpu/";
+    auto read_int = [](const std::string& path, int fallback) {
+        std::ifstream file{ path };
+        int value;
+        return file >> value ? value : fallback;
+    };
+
+    std::vector<int> cpus;
+    if (std::ifstream online{ base + "online" }; online) {
+        std::string list;
+        std::getline(online, list);
+        cpus = parse_cpu_list(list);
+    }
+    if (cpus.empty()) {
+        for (unsigned i = 0; i < std::thread::hardware_concurrency(); i++) {
+            cpus.push_back(static_cast<int>(i));
+        }
+    }
+
+    std::vector<cpu_info> topology;
+    std::map<std::tuple<int, int>, int> threads_per_core;
+    for (int cpu : cpus) {
+        auto topology_dir = base + "cpu" + std::to_string(cpu) + "/topology/";
+        int package = read_int(topology_dir + "physical_package_id", 0);
+        int core = read_int(topology_dir + "core_id", cpu);
+        topology.push_back({ cpu, package, core, threads_per_core[{ package, core }]++ });
+    }
+    return topology;
+}
+
+// Order in which threads are assigned to the CPUs of topology.
+inline std::vector<cpu_info> pinning_order(std::vector<cpu_info> topology, pinning_strategy strategy) {
+    auto by = [](auto key) {
+        return [key](const auto& a, const auto& b) { return key(a) < key(b); };
+    };
+    switch (strategy) {
+    case pinning_strategy::LOGICAL:
+    case pinning_strategy::LIST:
+        std::ranges::sort(topology, by([](const cpu_info& c) { return c.cpu; }));
+        break;
+    case pinning_strategy::COMPACT:
+        std::ranges::sort(topology, by([](const cpu_info& c) { return std::tuple{ c.package, c.core, c.cpu }; }));
+        break;
+    case pinning_strategy::CORES_THEN_SMT:
+        std::ranges::sort(topology, by([](const cpu_info& c) { return std::tuple{ c.smt_index, c.package, c.core, c.cpu }; }));
+        break;
+    case pinning_strategy::SCATTER: {
+        std::ranges::sort(topology, by([](const cpu_info& c) { return std::tuple{ c.smt_index, c.package, c.core, c.cpu }; }));
+        // Rank of each CPU within its package, then interleave packages by that rank.
+        std::map<int, int> per_package;
+        std::vector<std::tuple<int, int, cpu_info>> ranked;
+        for (const auto& c : topology) {
+            ranked.emplace_back(per_package[c.package]++, c.package, c);
+        }
+        std::ranges::stable_sort(ranked, by([](const auto& r) { return std::tuple{ std::get<0>(r), std::get<1>(r) }; }));
+        for (std::size_t i = 0; i < ranked.size(); i++) {
+            topology[i] = std::get<2>(ranked[i]);
+        }
+    } break;
+    }
+    return topology;
+}
+
+#endif // CPU_TOPOLOGY_HPP_INCLUDED
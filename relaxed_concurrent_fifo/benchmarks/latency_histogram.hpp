@@ -0,0 +1,154 @@
+#ifndef LATENCY_HISTOGRAM_HPP_INCLUDED
+#define LATENCY_HISTOGRAM_HPP_INCLUDED
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <optional>
+#include <vector>
+
+#include "../contenders/multififo/timestamp.hpp"
+#include "../utility.h"
+
+// Log-linear (HDR-style) histogram: Values below 2^SUB_BUCKET_BITS are counted exactly, above that every power of two
+// is split into 2^SUB_BUCKET_BITS equally sized buckets, bounding the relative error by 2^-SUB_BUCKET_BITS.
+class latency_histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+
+private:
+    static constexpr std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    std::vector<std::uint64_t> counts = std::vector<std::uint64_t>(BUCKET_COUNT);
+    std::uint64_t total = 0;
+    std::uint64_t max_value = 0;
+
+    static std::size_t index_of(std::uint64_t value) {
+        if (value < SUB_BUCKETS) {
+            return value;
+        }
+        int shift = std::bit_width(value) - SUB_BUCKET_BITS - 1;
+        return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    // Largest value counted in a bucket.
+    static std::uint64_t value_of(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+        return ((SUB_BUCKETS + index % SUB_BUCKETS + 1) << shift) - 1;
+    }
+
+public:
+    void record(std::uint64_t value) {
+        counts[index_of(value)]++;
+        total++;
+        max_value = std::max(max_value, value);
+    }
+
+    void merge(const latency_histogram& other) {
+        for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        max_value = std::max(max_value, other.max_value);
+    }
+
+    std::uint64_t count() const {
+        return total;
+    }
+
+    std::uint64_t max() const {
+        return max_value;
+    }
+
+    // Upper bound of the bucket holding the value at quantile q, capped at the maximum recorded value.
+    std::uint64_t percentile(double q) const {
+        if (total == 0) {
+            return 0;
+        }
+        auto rank = static_cast<std::uint64_t>(q * (total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(value_of(i), max_value);
+            }
+        }
+        return max_value;
+    }
+};
+
+#define LATENCY_HEADER "latency_p50_ticks,latency_p90_ticks,latency_p99_ticks,latency_p999_ticks,latency_max_ticks"
+
+// Optional latency recording for benchmarks, measured in multififo::get_timestamp() ticks (TSC cycles on x86).
+// Every thread times every sample_interval-th operation passed through its sampler; 0 disables recording,
+// leaving only a countdown per operation.
+struct latency_recorder {
+    static inline std::uint64_t sample_interval = 0;
+
+    static constexpr const char* header = LATENCY_HEADER;
+
+    static bool enabled() {
+        return sample_interval != 0;
+    }
+
+    // Also usable on its own by benchmarks that always record latencies, with a fixed interval.
+    class sampler {
+    private:
+        latency_histogram& histogram;
+        std::uint64_t interval;
+        std::uint64_t countdown;
+
+    public:
+        sampler(latency_histogram& histogram, std::uint64_t interval) : histogram(histogram), interval(interval),
+            countdown(interval != 0 ? interval : std::numeric_limits<std::uint64_t>::max()) { }
+
+        template <typename F>
+        decltype(auto) operator()(F&& f) {
+            if (--countdown != 0) [[likely]] {
+                return f();
+            }
+            countdown = interval;
+            auto start = multififo::get_timestamp();
+            decltype(auto) ret = f();
+            histogram.record(multififo::get_timestamp() - start);
+            return ret;
+        }
+    };
+
+    // One cache line per thread, so that recording does not cause false sharing.
+    using histograms = std::vector<cache_aligned_t<latency_histogram>>;
+
+    histograms latencies;
+
+    latency_recorder(int num_threads) : latencies(enabled() ? num_threads : 0) { }
+
+    sampler get_sampler(int thread_index) {
+        // Threads share a dummy histogram that is never written to if recording is disabled.
+        static latency_histogram unused;
+        return enabled() ? sampler{ latencies[thread_index], sample_interval } : sampler{ unused, 0 };
+    }
+
+    // The columns of LATENCY_HEADER for the histograms of all threads combined.
+    template <typename T>
+    static void output_histograms(T& stream, const histograms& per_thread) {
+        latency_histogram merged;
+        for (const latency_histogram& histogram : per_thread) {
+            merged.merge(histogram);
+        }
+        stream << merged.percentile(0.5) << ',' << merged.percentile(0.9) << ',' << merged.percentile(0.99) << ','
+            << merged.percentile(0.999) << ',' << merged.max();
+    }
+
+    template <typename T>
+    void output_latency(T& stream) {
+        output_histograms(stream, latencies);
+    }
+};
+
+#endif // LATENCY_HISTOGRAM_HPP_INCLUDED
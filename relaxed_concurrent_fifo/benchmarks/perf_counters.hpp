@@ -0,0 +1,167 @@
+#ifndef PERF_COUNTERS_HPP_INCLUDED
+#define PERF_COUNTERS_HPP_INCLUDED
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif // __linux__
+
+// Hardware event totals of a benchmark run, summed over all its threads.
+struct perf_counter_values {
+    static constexpr std::size_t EVENT_COUNT = 5;
+    static constexpr std::array<const char*, EVENT_COUNT> names{ "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+
+    std::array<std::uint64_t, EVENT_COUNT> values{};
+    // Events the kernel or the CPU does not support stay unavailable.
+    std::array<bool, EVENT_COUNT> available{};
+
+    void add(const perf_counter_values& other) {
+        for (std::size_t i = 0; i < EVENT_COUNT; i++) {
+            values[i] += other.values[i];
+            available[i] |= other.available[i];
+        }
+    }
+
+    static std::string header() {
+        std::string header;
+        for (auto name : names) {
+            header += header.empty() ? "" : ",";
+            header += name;
+            header += "_per_operation";
+        }
+        return header;
+    }
+
+    // Empty columns for unavailable events.
+    template <typename T>
+    void output_per_operation(T& stream, std::uint64_t operations) const {
+        for (std::size_t i = 0; i < EVENT_COUNT; i++) {
+            if (i != 0) {
+                stream << ',';
+            }
+            if (available[i] && operations != 0) {
+                stream << static_cast<double>(values[i]) / operations;
+            }
+        }
+    }
+};
+
+// Counts the events of perf_counter_values for the thread constructing it, as one perf_event_open group so they are
+// scheduled together. Events that fail to open are left out; without any, start, stop and read do nothing.
+class perf_counter_group {
+public:
+    // Set by the command line, and cleared again if not even one event can be opened.
+    static inline bool enabled = false;
+
+    // Group of the calling benchmark thread, started by start_current() once the measurement begins.
+    static inline thread_local perf_counter_group* current = nullptr;
+
+    static void start_current() {
+        if (current != nullptr) {
+            current->start();
+        }
+    }
+
+private:
+    std::array<int, perf_counter_values::EVENT_COUNT> fds;
+    int leader = -1;
+
+#ifdef __linux__
+    static int open_event(std::uint32_t type, std::uint64_t config, int group_fd) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = group_fd == -1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+#endif // __linux__
+
+public:
+    perf_counter_group() {
+        fds.fill(-1);
+#ifdef __linux__
+        constexpr std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::array<std::pair<std::uint32_t, std::uint64_t>, perf_counter_values::EVENT_COUNT> events{ {
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+            { PERF_TYPE_HW_CACHE, l1d_read_miss },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+            { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        } };
+        for (std::size_t i = 0; i < events.size(); i++) {
+            fds[i] = open_event(events[i].first, events[i].second, leader);
+            if (leader == -1) {
+                leader = fds[i];
+            }
+        }
+#endif // __linux__
+    }
+
+    ~perf_counter_group() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd != -1) {
+                close(fd);
+            }
+        }
+#endif // __linux__
+    }
+
+    perf_counter_group(const perf_counter_group&) = delete;
+    perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+    bool valid() const {
+        return leader != -1;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (valid()) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif // __linux__
+    }
+
+    void stop() {
+#ifdef __linux__
+        if (valid()) {
+            ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif // __linux__
+    }
+
+    // Scaled up by the fraction of time the group was actually counting, in case it was multiplexed.
+    perf_counter_values read() const {
+        perf_counter_values result;
+#ifdef __linux__
+        for (std::size_t i = 0; i < fds.size(); i++) {
+            struct {
+                std::uint64_t value;
+                std::uint64_t time_enabled;
+                std::uint64_t time_running;
+            } data;
+            if (fds[i] == -1 || ::read(fds[i], &data, sizeof(data)) != sizeof(data)) {
+                continue;
+            }
+            result.available[i] = true;
+            result.values[i] = data.time_running == 0 ? 0
+                : static_cast<std::uint64_t>(static_cast<double>(data.value) * data.time_enabled / data.time_running);
+        }
+#endif // __linux__
+        return result;
+    }
+};
+
+#endif // PERF_COUNTERS_HPP_INCLUDED
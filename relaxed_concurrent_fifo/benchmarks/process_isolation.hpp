@@ -0,0 +1,134 @@
+#ifndef PROCESS_ISOLATION_HPP_INCLUDED
+#define PROCESS_ISOLATION_HPP_INCLUDED
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // __linux__
+
+#include "time_series.hpp"
+
+// Runs every benchmark invocation in a freshly forked child process, so that allocator state, page cache and THP
+// residency and global state of contenders don't carry over from one run to the next. The child writes its result
+// line into a pipe; a crash, non-zero exit or a run exceeding its time limit is reported in place of the result.
+struct process_isolation {
+    static inline bool enabled = false;
+    // Allowed on top of the benchmark's own running time before a run is considered deadlocked.
+    static inline std::chrono::seconds timeout{ 600 };
+
+    // Returns what f wrote to the std::ostream passed to it, or ERR_TIMEOUT, ERR_SIGNAL_<signal> or ERR_EXIT_<status>.
+    // A child terminated by an exception exits with status 2.
+    template <typename F>
+    static std::string run(F&& f, std::chrono::seconds running_time) {
+#ifdef __linux__
+        // Buffered output would otherwise be written by both processes.
+        std::cout.flush();
+        time_series::file.flush();
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Failed to create pipe!");
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            throw std::runtime_error("Failed to fork!");
+        }
+
+        if (pid == 0) {
+            // An exception must not unwind into the parent's code, which would continue as a second process.
+            try {
+                close(fds[0]);
+                std::ostringstream result;
+                f(result);
+                auto str = result.str();
+                for (std::size_t written = 0; written < str.size(); ) {
+                    auto n = write(fds[1], str.data() + written, str.size() - written);
+                    if (n < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        _exit(1);
+                    }
+                    written += n;
+                }
+                std::cout.flush();
+                time_series::file.flush();
+            } catch (const std::exception& e) {
+                std::cerr << "Run threw an exception: " << e.what() << std::endl;
+                _exit(2);
+            } catch (...) {
+                _exit(2);
+            }
+            // Skip destructors and atexit handlers, they belong to the parent.
+            _exit(0);
+        }
+
+        close(fds[1]);
+        std::string result;
+        bool timed_out = false;
+        auto deadline = std::chrono::steady_clock::now() + running_time + timeout;
+        while (true) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) {
+                timed_out = true;
+                break;
+            }
+            pollfd pfd{ fds[0], POLLIN, 0 };
+            int ready = poll(&pfd, 1, static_cast<int>(std::min<std::chrono::milliseconds::rep>(remaining.count(), 1000)));
+            if (ready < 0 && errno != EINTR) {
+                throw std::runtime_error("Failed to poll pipe!");
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            char buffer[4096];
+            auto n = read(fds[0], buffer, sizeof(buffer));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            result.append(buffer, n);
+        }
+        close(fds[0]);
+
+        if (timed_out) {
+            kill(pid, SIGKILL);
+        }
+        int status;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) { }
+
+        if (timed_out) {
+            std::cout << "Run did not complete within " << (running_time + timeout).count() << " seconds, assuming deadlock!" << std::endl;
+            return "ERR_TIMEOUT";
+        }
+        if (WIFSIGNALED(status)) {
+            std::cout << "Run was terminated by signal " << WTERMSIG(status) << "!" << std::endl;
+            return "ERR_SIGNAL_" + std::to_string(WTERMSIG(status));
+        }
+        if (WEXITSTATUS(status) != 0) {
+            std::cout << "Run exited with status " << WEXITSTATUS(status) << "!" << std::endl;
+            return "ERR_EXIT_" + std::to_string(WEXITSTATUS(status));
+        }
+        return result;
+#else
+        (void)running_time;
+        std::ostringstream result;
+        f(result);
+        return result.str();
+#endif // __linux__
+    }
+};
+
+#endif // PROCESS_ISOLATION_HPP_INCLUDED
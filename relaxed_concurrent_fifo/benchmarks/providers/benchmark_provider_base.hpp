@@ -7,6 +7,9 @@
 #include <thread>
 #include <future>
 #include <vector>
+#include <mutex>
+#include <memory>
+#include <optional>
 #include <stdexcept>
 #include <iostream>
 
@@ -15,8 +18,61 @@
 #endif // _POSIX_VERSION
 
 #include "../benchmark_base.hpp"
+#include "../cpu_topology.hpp"
+#include "../time_series.hpp"
 #include "../../fifo.h"
 
+// Which processors benchmark threads are pinned to.
+struct thread_pinning {
+    static inline bool enabled = true;
+    static inline pinning_strategy strategy = pinning_strategy::LOGICAL;
+    // Thread i runs on cpus[i % cpus.size()], or on processor i % hardware_concurrency() if empty.
+    // Oversubscribed runs wrap around, placing several threads on each processor.
+    static inline std::vector<int> cpus;
+
+    static void use_strategy(pinning_strategy new_strategy) {
+        strategy = new_strategy;
+        cpus.clear();
+        for (const auto& c : pinning_order(read_cpu_topology(), strategy)) {
+            cpus.push_back(c.cpu);
+        }
+    }
+
+    static void use_list(std::vector<int> list) {
+        strategy = pinning_strategy::LIST;
+        cpus = std::move(list);
+    }
+
+    // One line per CPU slot in assignment order, so that thread i ran on the CPU of slot i % slot count.
+    template <typename T>
+    static void write_mapping(T& stream) {
+        stream << "# pinning=" << (enabled ? pinning_strategy_name(strategy) : "none") << '\n';
+        stream << "slot,cpu,package,core,smt_index\n";
+        if (!enabled) {
+            return;
+        }
+        auto topology = read_cpu_topology();
+        for (int i = 0; i < cpu_count(); i++) {
+            int cpu = cpu_of(i);
+            auto it = std::ranges::find(topology, cpu, &cpu_info::cpu);
+            stream << i << ',' << cpu << ',';
+            if (it != topology.end()) {
+                stream << it->package << ',' << it->core << ',' << it->smt_index << '\n';
+            } else {
+                stream << "-1,-1,-1\n";
+            }
+        }
+    }
+
+    static int cpu_count() {
+        return cpus.empty() ? static_cast<int>(std::thread::hardware_concurrency()) : static_cast<int>(cpus.size());
+    }
+
+    static int cpu_of(int thread_index) {
+        return cpus.empty() ? thread_index % std::thread::hardware_concurrency() : cpus[thread_index % cpus.size()];
+    }
+};
+
 template <typename BENCHMARK>
 class benchmark_provider {
 public:
@@ -25,22 +81,39 @@ public:
     virtual const std::string& get_name() const = 0;
 
 protected:
+    static void pin_thread(int thread_index) {
+#ifdef _POSIX_VERSION
+        if (thread_pinning::enabled) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(thread_pinning::cpu_of(thread_index), &cpu_set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set)) {
+                throw std::runtime_error("Failed to set thread affinity!");
+            }
+        }
+#else
+        (void)thread_index;
+#endif // _POSIX_VERSION
+    }
+
     template <fifo FIFO>
     static void test_single(FIFO& fifo, BENCHMARK& b, const benchmark_info& info, double prefill_amount) {
         std::barrier a{info.num_threads + 1};
         std::atomic_bool over = false;
         std::vector<std::jthread> threads(info.num_threads);
+        std::mutex perf_mutex;
+
+        std::vector<cache_aligned_t<std::atomic_uint64_t>> progress;
+        if constexpr (requires { b.thread_operations(); }) {
+            if (time_series::enabled()) {
+                progress = std::vector<cache_aligned_t<std::atomic_uint64_t>>(info.num_threads);
+                b.progress = progress.data();
+            }
+        }
 
         for (int i = 0; i < info.num_threads; i++) {
             threads[i] = std::jthread([&, i]() {
-#ifdef _POSIX_VERSION
-                cpu_set_t cpu_set;
-                CPU_ZERO(&cpu_set);
-                CPU_SET(i, &cpu_set);
-                if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set)) {
-                    throw std::runtime_error("Failed to set thread affinity!");
-                }
-#endif // _POSIX_VERSION
+                pin_thread(i);
 
                 // Make sure handle is acquired on the thread it will be used on.
                 typename FIFO::handle handle = fifo.get_handle();
@@ -57,17 +130,52 @@ protected:
                     }
                 }
 
+                // Only the benchmark itself is counted, the benchmark starts the counters via BENCHMARK::start_measurement.
+                std::optional<perf_counter_group> counters;
+                if (perf_counter_group::enabled) {
+                    counters.emplace();
+                    perf_counter_group::current = &*counters;
+                }
+
                 if constexpr (BENCHMARK::HAS_TIMEOUT) {
                     b.template per_thread<FIFO>(i, handle, a, over);
                 } else {
                     b.template per_thread<FIFO>(i, handle, a);
                 }
+
+                if (counters.has_value()) {
+                    counters->stop();
+                    perf_counter_group::current = nullptr;
+                    std::scoped_lock lock{ perf_mutex };
+                    b.perf_counters.add(counters->read());
+                }
             });
         }
 
         // We signal, then start taking the time because some threads might not have arrived at the signal.
         a.arrive_and_wait();
         auto start = std::chrono::steady_clock::now();
+        std::jthread sampler;
+        if (!progress.empty()) {
+            sampler = std::jthread([&](std::stop_token stop) {
+                for (auto next = start + time_series::interval; !stop.stop_requested(); next += time_series::interval) {
+                    std::this_thread::sleep_until(next);
+                    std::uint64_t total = 0;
+                    std::string per_thread;
+                    for (auto& counter : progress) {
+                        auto operations = counter->load(std::memory_order_relaxed);
+                        total += operations;
+                        if (!per_thread.empty()) {
+                            per_thread += ';';
+                        }
+                        per_thread += std::to_string(operations);
+                    }
+                    time_series::file << time_series::label << ','
+                        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << ','
+                        << total << ',' << per_thread << '\n';
+                }
+            });
+        }
         auto joined = std::async([&]() {
             for (auto& thread : threads) {
                 thread.join();
@@ -93,6 +201,54 @@ protected:
         if constexpr (BENCHMARK::RECORD_TIME) {
             b.time_nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
         }
+        if (sampler.joinable()) {
+            sampler.request_stop();
+            sampler.join();
+        }
+        b.progress = nullptr;
+    }
+
+    // For benchmarks spanning several queues of the same kind (see BENCHMARK::queue_count()), every thread gets a handle
+    // to each of them. There is no prefill; while the benchmark runs, the calling thread invokes BENCHMARK::sample()
+    // every BENCHMARK::SAMPLE_INTERVAL.
+    template <fifo FIFO>
+    static void test_multiple(std::vector<std::unique_ptr<FIFO>>& fifos, BENCHMARK& b, const benchmark_info& info) {
+        static_assert(BENCHMARK::HAS_TIMEOUT && !BENCHMARK::RECORD_TIME);
+        std::barrier a{info.num_threads + 1};
+        std::atomic_bool over = false;
+        std::vector<std::jthread> threads(info.num_threads);
+
+        for (int i = 0; i < info.num_threads; i++) {
+            threads[i] = std::jthread([&, i]() {
+                pin_thread(i);
+                std::vector<typename FIFO::handle> handles;
+                handles.reserve(fifos.size());
+                for (auto& fifo : fifos) {
+                    handles.push_back(fifo->get_handle());
+                }
+                b.template per_thread<FIFO>(i, handles, a, over);
+            });
+        }
+
+        a.arrive_and_wait();
+        auto start = std::chrono::steady_clock::now();
+        auto end = start + std::chrono::seconds(info.test_time_seconds);
+        for (auto next = start + BENCHMARK::SAMPLE_INTERVAL; next < end; next += BENCHMARK::SAMPLE_INTERVAL) {
+            std::this_thread::sleep_until(next);
+            b.sample();
+        }
+        std::this_thread::sleep_until(end);
+        over = true;
+
+        auto joined = std::async([&]() {
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        });
+        if (joined.wait_for(std::chrono::seconds(10)) == std::future_status::timeout) {
+            std::cout << "Threads did not complete within timeout, assuming deadlock!" << std::endl;
+            std::exit(1);
+        }
     }
 };
 
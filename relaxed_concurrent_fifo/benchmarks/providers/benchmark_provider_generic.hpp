@@ -16,8 +16,16 @@ public:
 
     BENCHMARK test(const benchmark_info& info, double prefill_amount) const override {
         BENCHMARK b{info};
-        FIFO fifo = std::apply([&](Args... args) { return FIFO{ info.num_threads, b.fifo_size, args...}; }, args);
-        benchmark_provider<BENCHMARK>::template test_single<FIFO>(fifo, b, info, prefill_amount);
+        if constexpr (requires { b.queue_count(); }) {
+            std::vector<std::unique_ptr<FIFO>> fifos;
+            for (std::size_t i = 0; i < b.queue_count(); i++) {
+                fifos.push_back(std::apply([&](Args... args) { return std::make_unique<FIFO>(info.num_threads, b.fifo_size, args...); }, args));
+            }
+            benchmark_provider<BENCHMARK>::template test_multiple<FIFO>(fifos, b, info);
+        } else {
+            FIFO fifo = std::apply([&](Args... args) { return FIFO{ info.num_threads, b.fifo_size, args...}; }, args);
+            benchmark_provider<BENCHMARK>::template test_single<FIFO>(fifo, b, info, prefill_amount);
+        }
         return b;
     }
 
@@ -0,0 +1,61 @@
+#ifndef BENCHMARK_PROVIDER_HUGEPAGE_HPP_INCLUDED
+#define BENCHMARK_PROVIDER_HUGEPAGE_HPP_INCLUDED
+
+#include "benchmark_provider_base.hpp"
+
+#include <format>
+#include <iostream>
+
+#include "block_based_queue.h"
+#include "hugepage_arena.h"
+
+// Places the entire block-based queue (blocks and both bitsets) in a fresh huge page arena per run.
+template <typename BENCHMARK>
+class benchmark_provider_bbq_hugepage : public benchmark_provider<BENCHMARK> {
+public:
+    using fifo_t = block_based_queue<std::uint64_t, std::uint8_t, hugepage_arena_allocator<std::byte>>;
+
+    benchmark_provider_bbq_hugepage(std::string_view name, double blocks_per_window_per_thread, std::size_t cells_per_block) :
+        name(std::vformat(name, std::make_format_args(blocks_per_window_per_thread, cells_per_block))),
+        blocks_per_window_per_thread(blocks_per_window_per_thread),
+        cells_per_block(cells_per_block) { }
+
+    const std::string& get_name() const override {
+        return name;
+    }
+
+    BENCHMARK test(const benchmark_info& info, double prefill_amount) const override {
+        BENCHMARK b{info};
+        hugepage_arena arena;
+        if constexpr (requires { b.queue_count(); }) {
+            std::vector<std::unique_ptr<fifo_t>> fifos;
+            for (std::size_t i = 0; i < b.queue_count(); i++) {
+                fifos.push_back(std::make_unique<fifo_t>(info.num_threads, b.fifo_size, blocks_per_window_per_thread, cells_per_block,
+                    hugepage_arena_allocator<std::byte>{ arena }));
+            }
+            benchmark_provider<BENCHMARK>::template test_multiple<fifo_t>(fifos, b, info);
+        } else {
+            fifo_t fifo{ info.num_threads, b.fifo_size, blocks_per_window_per_thread, cells_per_block, hugepage_arena_allocator<std::byte>{ arena } };
+            benchmark_provider<BENCHMARK>::template test_single<fifo_t>(fifo, b, info, prefill_amount);
+        }
+        report_page_kind(arena);
+        return b;
+    }
+
+private:
+    std::string name;
+    double blocks_per_window_per_thread;
+    std::size_t cells_per_block;
+    mutable bool reported = false;
+
+    // Logged once per instance, as results differ a lot between reserved and transparent huge pages.
+    void report_page_kind(const hugepage_arena& arena) const {
+        if (!reported) {
+            reported = true;
+            std::cout << "Notice: " << name << " is backed by " << (arena.uses_hugetlb() ? "reserved (MAP_HUGETLB)" : "transparent")
+                << " huge pages" << std::endl;
+        }
+    }
+};
+
+#endif // BENCHMARK_PROVIDER_HUGEPAGE_HPP_INCLUDED
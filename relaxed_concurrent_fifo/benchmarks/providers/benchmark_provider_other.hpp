@@ -4,6 +4,9 @@
 #include "benchmark_provider_generic.hpp"
 
 #include "block_based_queue.h"
+#include "block_based_queue_tuning.h"
+#include "block_based_stack.h"
+#include "bucket_priority_queue.h"
 #include "contenders/scal/scal_wrapper.h"
 #include "contenders/multififo/multififo.hpp"
 #include "contenders/multififo/stick_random.hpp"
@@ -27,6 +30,19 @@
 template <typename BENCHMARK>
 using benchmark_provider_bbq = benchmark_provider_generic<block_based_queue<std::uint64_t>, BENCHMARK, double, std::size_t>;
 
+template <typename BENCHMARK, typename BACKOFF>
+using benchmark_provider_bbq_backoff = benchmark_provider_generic<block_based_queue<std::uint64_t, std::uint8_t, std::allocator<std::byte>, false, BACKOFF>,
+    BENCHMARK, double, std::size_t>;
+
+template <typename BENCHMARK>
+using benchmark_provider_bbq_tuned = benchmark_provider_generic<tuned_block_based_queue<std::uint64_t>, BENCHMARK>;
+
+template <typename BENCHMARK>
+using benchmark_provider_bbs = benchmark_provider_generic<block_based_stack<std::uint64_t>, BENCHMARK, double, std::size_t>;
+
+template <typename BENCHMARK>
+using benchmark_provider_bucket_pq = benchmark_provider_generic<bucket_priority_queue<std::uint64_t>, BENCHMARK, int, std::uint64_t, double, std::size_t>;
+
 template <typename BENCHMARK>
 using benchmark_provider_kfifo = benchmark_provider_generic<ws_k_fifo<std::uint64_t>, BENCHMARK, double>;
 
@@ -0,0 +1,48 @@
+#ifndef THREAD_DISTRIBUTION_HPP_INCLUDED
+#define THREAD_DISTRIBUTION_HPP_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ranges>
+
+// Columns describing how evenly operations were spread over the threads of a run. Jain's fairness index
+// (sum x)^2 / (n * sum x^2) is 1 if all threads did the same amount of work and 1 / n if only one did any.
+#define THREAD_DISTRIBUTION_HEADER "min_thread_operations,max_thread_operations,stddev_thread_operations,jain_fairness"
+
+struct thread_distribution {
+    // Additionally write the raw per-thread counts, separated by semicolons, as the last column.
+    static inline bool dump_per_thread = false;
+
+    static constexpr const char* per_thread_header = "per_thread_operations";
+
+    template <typename T, std::ranges::sized_range R>
+    static void output(T& stream, const R& counts) {
+        if (std::ranges::empty(counts)) {
+            stream << "0,0,0,0";
+            return;
+        }
+        double n = static_cast<double>(std::ranges::size(counts));
+        double sum = 0;
+        double sum_squares = 0;
+        for (auto count : counts) {
+            sum += static_cast<double>(count);
+            sum_squares += static_cast<double>(count) * static_cast<double>(count);
+        }
+        double mean = sum / n;
+        double stddev = std::sqrt(std::max(0., sum_squares / n - mean * mean));
+        double jain = sum_squares == 0 ? 1 : sum * sum / (n * sum_squares);
+        stream << std::ranges::min(counts) << ',' << std::ranges::max(counts) << ',' << stddev << ',' << jain;
+    }
+
+    template <typename T, std::ranges::range R>
+    static void output_per_thread(T& stream, const R& counts) {
+        bool first = true;
+        for (auto count : counts) {
+            stream << (first ? "" : ";") << count;
+            first = false;
+        }
+    }
+};
+
+#endif // THREAD_DISTRIBUTION_HPP_INCLUDED
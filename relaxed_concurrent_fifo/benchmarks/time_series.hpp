@@ -0,0 +1,24 @@
+#ifndef TIME_SERIES_HPP_INCLUDED
+#define TIME_SERIES_HPP_INCLUDED
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+// Settings of the time series sampler in benchmark_provider::test_single. While enabled, it reads the per-thread
+// progress counters of benchmarks that report them every interval and appends the cumulative counts to file.
+struct time_series {
+    static inline std::chrono::milliseconds interval{ 0 };
+    // Opened next to every result file while interval is set.
+    static inline std::ofstream file;
+    // Queue name and thread count of the current run.
+    static inline std::string label;
+
+    static constexpr const char* header = "queue,thread_count,time_milliseconds,operations,per_thread_operations";
+
+    static bool enabled() {
+        return interval.count() > 0 && file.is_open();
+    }
+};
+
+#endif // TIME_SERIES_HPP_INCLUDED
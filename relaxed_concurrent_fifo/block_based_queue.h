@@ -7,8 +7,22 @@
 #include <random>
 #include <new>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __unix__
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // __unix__
 
 #include "fifo.h"
+#include "backoff.h"
 #include "atomic_bitset.h"
 #include "atomic_bitset_no_epoch.h"
 
@@ -59,9 +73,34 @@ struct block {
 	static_assert(std::is_trivially_destructible_v<std::atomic<T>>);
 };
 
-template <typename T, typename BITSET_T = std::uint8_t>
+// Smallest multiple of alignment that fits a block of the given size, so consecutive blocks stay aligned.
+static constexpr std::size_t align_block_size(std::size_t size, std::size_t alignment) {
+	std::size_t ret = alignment;
+	while (ret < size) {
+		ret += alignment;
+	}
+	return ret;
+}
+
+// COMPACT trades contention resistance for footprint, for use cases with many small queues:
+// Bitset units and the global window indices are not padded to cache lines and blocks are only
+// aligned to their header instead of occupying whole cache lines.
+// BACKOFF is applied after failed header and bitset CASes (see backoff.h).
+template <typename T, typename BITSET_T = std::uint8_t, typename Allocator = std::allocator<std::byte>, bool COMPACT = false,
+	backoff_policy BACKOFF = backoff_none>
 class block_based_queue {
+public:
+	using backoff_t = BACKOFF;
+
 private:
+	static constexpr std::size_t block_alignment = COMPACT ? alignof(std::atomic_uint64_t) : std::hardware_destructive_interference_size;
+
+	// The buffer is allocated in units of this, so that the allocator is asked for the alignment of the blocks.
+	struct alignas(block_alignment) buffer_unit {
+		std::byte bytes[block_alignment];
+	};
+	using buffer_allocator_t = typename std::allocator_traits<Allocator>::template rebind_alloc<buffer_unit>;
+
 	std::size_t blocks_per_window;
 	std::uniform_int_distribution<int> window_block_distribution;
 
@@ -87,9 +126,10 @@ private:
 	static inline std::atomic_uint64_t dummy_block_value{ epoch_to_header(0x1000'0000ull) };
 	static inline block_t dummy_block{ reinterpret_cast<std::byte*>(&dummy_block_value) };
 
-	atomic_bitset_no_epoch<BITSET_T> touched_set;
-	atomic_bitset<BITSET_T> filled_set;
-	std::unique_ptr<std::byte[]> buffer;
+	[[no_unique_address]] buffer_allocator_t alloc;
+	atomic_bitset_no_epoch<BITSET_T, Allocator, COMPACT, BACKOFF> touched_set;
+	atomic_bitset<BITSET_T, Allocator, COMPACT, BACKOFF> filled_set;
+	std::byte* buffer;
 
 	std::uint64_t window_to_epoch(std::uint64_t window) const {
 		return window >> window_count_log2;
@@ -137,19 +177,18 @@ private:
 		return get_block(index, free_bit);
 	}
 
-	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t global_read_window = 0;
-	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t global_write_window = 1;
+	static constexpr std::size_t window_alignment = COMPACT ? alignof(std::atomic_uint64_t) : std::hardware_destructive_interference_size;
+	alignas(window_alignment) std::atomic_uint64_t global_read_window = 0;
+	alignas(window_alignment) std::atomic_uint64_t global_write_window = 1;
 
-	static constexpr std::size_t align_cache_line_size(std::size_t size) {
-		std::size_t ret = std::hardware_destructive_interference_size;
-		while (ret < size) {
-			ret += std::hardware_destructive_interference_size;
-		}
-		return ret;
+	// Block sizes are multiples of block_alignment, so the buffer consists of whole units.
+	std::size_t buffer_units() const {
+		return window_count * blocks_per_window * block_size / sizeof(buffer_unit);
 	}
 
 public:
-	block_based_queue(int thread_count, std::size_t min_size, double blocks_per_window_per_thread, std::size_t cells_per_block) :
+	block_based_queue(int thread_count, std::size_t min_size, double blocks_per_window_per_thread, std::size_t cells_per_block,
+		const Allocator& alloc = {}) :
 			blocks_per_window(std::bit_ceil(std::max<std::size_t>(sizeof(BITSET_T) * 8,
 				std::lround(thread_count * blocks_per_window_per_thread)))),
 			window_block_distribution(0, static_cast<int>(blocks_per_window - 1)),
@@ -157,10 +196,11 @@ public:
 			window_count_mod_mask(window_count - 1),
 			window_count_log2(std::bit_width(window_count) - 1),
 			cells_per_block(cells_per_block),
-			block_size(align_cache_line_size(sizeof(std::atomic_uint64_t) + cells_per_block * sizeof(T))),
-			touched_set(window_count, blocks_per_window),
-			filled_set(window_count, blocks_per_window),
-			buffer(std::make_unique<std::byte[]>(window_count * blocks_per_window * block_size)) {
+			block_size(align_block_size(sizeof(std::atomic_uint64_t) + cells_per_block * sizeof(T), block_alignment)),
+			alloc(alloc),
+			touched_set(window_count, blocks_per_window, alloc),
+			filled_set(window_count, blocks_per_window, alloc),
+			buffer(reinterpret_cast<std::byte*>(std::allocator_traits<buffer_allocator_t>::allocate(this->alloc, buffer_units()))) {
 #if BBQ_LOG_CREATION_SIZE
 		std::cout << "Window count: " << window_count << std::endl;
 		std::cout << "Block count: " << blocks_per_window << std::endl;
@@ -171,7 +211,7 @@ public:
 		assert(std::bit_ceil(blocks_per_window) == blocks_per_window);
 
 		for (std::size_t i = 0; i < window_count * blocks_per_window; i++) {
-			auto ptr = buffer.get() + i * block_size;
+			auto ptr = buffer + i * block_size;
 			new (ptr) std::atomic_uint64_t{ 0 };
 			for (std::size_t j = 0; j < cells_per_block; j++) {
 				new (ptr + sizeof(std::atomic_uint64_t) + j * sizeof(T)) std::atomic<T>{ };
@@ -184,6 +224,175 @@ public:
 		}
 	}
 
+	~block_based_queue() {
+		std::allocator_traits<buffer_allocator_t>::deallocate(alloc, reinterpret_cast<buffer_unit*>(buffer), buffer_units());
+	}
+
+	block_based_queue(const block_based_queue&) = delete;
+	block_based_queue& operator=(const block_based_queue&) = delete;
+
+	// Empties the queue while reusing its memory. Must not be called concurrently with any other operation.
+	// Instead of reinitializing everything, both windows are moved to a fresh epoch, so only the block headers,
+	// the bitsets and cells still holding elements need to be touched. Existing handles remain usable,
+	// since the new epoch invalidates the blocks they have cached. All stores are relaxed, the synchronization
+	// separating this call from later operations on other threads (e.g. joining or a barrier) publishes them.
+	void clear() {
+		// The new read window has window index 0 and the same role as window 0 after construction.
+		std::uint64_t base_window = (global_write_window.load(std::memory_order_relaxed) / window_count + 1) * window_count;
+		std::uint64_t epoch = window_to_epoch(base_window);
+
+		for (std::size_t i = 0; i < window_count; i++) {
+			std::uint64_t window_epoch = i == 0 ? epoch + 1 : epoch;
+			for (std::size_t j = 0; j < blocks_per_window; j++) {
+				block_t block = get_block(i, j);
+				std::uint64_t ei = block.get_header().load(std::memory_order_relaxed);
+				for (std::uint64_t k = get_read_index(ei); k < get_write_index(ei); k++) {
+					block.get_cell(k).store(0, std::memory_order_relaxed);
+				}
+				block.get_header().store(epoch_to_header(window_epoch), std::memory_order_relaxed);
+			}
+			touched_set.reset_window(i);
+			filled_set.reset_window(i, window_epoch);
+		}
+
+		global_read_window.store(base_window, std::memory_order_relaxed);
+		global_write_window.store(base_window + 1, std::memory_order_relaxed);
+	}
+
+	// Replaces the contents of the queue with the elements of the range, preserving their order.
+	// Must not be called concurrently with any other operation. Blocks are filled with plain stores (by thread_count
+	// threads, each taking a contiguous run of blocks) and the bitsets and windows are set up once afterwards.
+	// Returns the amount of elements stored, which is less than the size of the range if it exceeds the capacity.
+	// Like for clear, publishing the stores to other threads is left to the caller's synchronization.
+	template <std::ranges::random_access_range R>
+	std::size_t assign(R&& range, int thread_count = 1) {
+		clear();
+
+		// The read window is left empty, like after construction, all others can be filled.
+		std::uint64_t base_window = global_read_window.load(std::memory_order_relaxed);
+		std::uint64_t epoch = window_to_epoch(base_window);
+		std::size_t count = std::min<std::size_t>(std::ranges::size(range), (window_count - 1) * blocks_per_window * cells_per_block);
+		std::size_t block_count = (count + cells_per_block - 1) / cells_per_block;
+
+		auto fill_blocks = [&](std::size_t first_block, std::size_t last_block) {
+			auto it = std::ranges::begin(range);
+			for (std::size_t i = first_block; i < last_block; i++) {
+				block_t block = get_block(i / blocks_per_window + 1, i % blocks_per_window);
+				std::size_t first_cell = i * cells_per_block;
+				std::size_t cells = std::min(cells_per_block, count - first_cell);
+				for (std::size_t j = 0; j < cells; j++) {
+					block.get_cell(j).store(static_cast<T>(it[first_cell + j]), std::memory_order_relaxed);
+				}
+				block.get_header().store(epoch_to_header(epoch) | cells, std::memory_order_relaxed);
+			}
+		};
+
+		if (thread_count <= 1) {
+			fill_blocks(0, block_count);
+		} else {
+			std::vector<std::jthread> threads;
+			std::size_t blocks_per_thread = (block_count + thread_count - 1) / thread_count;
+			for (std::size_t first = 0; first < block_count; first += blocks_per_thread) {
+				threads.emplace_back(fill_blocks, first, std::min(block_count, first + blocks_per_thread));
+			}
+		}
+
+		std::size_t window_offset = 1;
+		for (std::size_t filled = 0; filled < block_count; filled += blocks_per_window, window_offset++) {
+			std::size_t blocks = std::min(blocks_per_window, block_count - filled);
+			filled_set.set_first(window_offset, blocks, epoch);
+			touched_set.set_first(window_offset, blocks);
+		}
+
+		global_write_window.store(base_window + std::max<std::size_t>(1, window_offset - 1), std::memory_order_relaxed);
+		return count;
+	}
+
+#ifdef __unix__
+	// Layout of the file written by snapshot, the elements follow as a plain T array.
+	struct snapshot_header {
+		char magic[4];
+		std::uint32_t version;
+		std::uint64_t element_size;
+		std::uint64_t count;
+	};
+	static constexpr snapshot_header snapshot_format{ { 'B', 'B', 'Q', 'S' }, 1, sizeof(T), 0 };
+
+	// Writes all elements between the read and write window to fd, in window order. Must not be called
+	// concurrently with any other operation. The queue itself is not modified.
+	void snapshot(int fd) {
+		auto write_all = [fd](const void* data, std::size_t size) {
+			auto ptr = static_cast<const std::byte*>(data);
+			while (size > 0) {
+				ssize_t written = ::write(fd, ptr, size);
+				if (written < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					throw std::runtime_error("Failed to write snapshot");
+				}
+				ptr += written;
+				size -= written;
+			}
+		};
+
+		snapshot_header header = snapshot_format;
+		header.count = size();
+		write_all(&header, sizeof(header));
+
+		// Cells are collected before writing to keep the number of syscalls low.
+		std::vector<T> pending;
+		pending.reserve(std::max<std::size_t>(cells_per_block, (1 << 20) / sizeof(T)));
+		for (std::uint64_t i = global_read_window; i <= global_write_window; i++) {
+			for (std::size_t j = 0; j < blocks_per_window; j++) {
+				block_t block = get_block(window_to_index(i), j);
+				std::uint64_t ei = block.get_header().load(std::memory_order_relaxed);
+				if (pending.size() + cells_per_block > pending.capacity()) {
+					write_all(pending.data(), pending.size() * sizeof(T));
+					pending.clear();
+				}
+				for (std::uint64_t k = get_read_index(ei); k < get_write_index(ei); k++) {
+					pending.push_back(block.get_cell(k).load(std::memory_order_relaxed));
+				}
+			}
+		}
+		write_all(pending.data(), pending.size() * sizeof(T));
+	}
+
+	// Replaces the contents of the queue with a snapshot read from fd, which is mapped into memory and passed to assign.
+	// Returns the amount of elements restored.
+	std::size_t load(int fd, int thread_count = 1) {
+		struct stat stats;
+		if (fstat(fd, &stats) != 0 || static_cast<std::size_t>(stats.st_size) < sizeof(snapshot_header)) {
+			throw std::runtime_error("Snapshot file is too small");
+		}
+		std::size_t file_size = stats.st_size;
+		void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped == MAP_FAILED) {
+			throw std::runtime_error("Failed to map snapshot");
+		}
+		madvise(mapped, file_size, MADV_SEQUENTIAL);
+
+		snapshot_header header;
+		std::memcpy(&header, mapped, sizeof(header));
+		if (std::memcmp(header.magic, snapshot_format.magic, sizeof(header.magic)) != 0 || header.version != snapshot_format.version
+				|| header.element_size != sizeof(T) || header.count > (file_size - sizeof(header)) / sizeof(T)) {
+			munmap(mapped, file_size);
+			throw std::runtime_error("Invalid snapshot file");
+		}
+
+		std::span<const T> elements{ reinterpret_cast<const T*>(static_cast<const std::byte*>(mapped) + sizeof(header)), header.count };
+		std::size_t count = assign(elements, thread_count);
+		munmap(mapped, file_size);
+		return count;
+	}
+#endif // __unix__
+
+	// Bytes allocated for blocks and bitsets, excluding the queue object itself.
+	std::size_t allocated_size() const {
+		return window_count * blocks_per_window * block_size + touched_set.allocated_size() + filled_set.allocated_size();
+	}
+
 	std::size_t capacity() const {
 		return window_count * blocks_per_window * cells_per_block;
 	}
@@ -354,6 +563,7 @@ public:
 			std::uint64_t ei = header->load(std::memory_order_relaxed);
 			std::uint64_t index;
 
+			BACKOFF backoff;
 			bool failure = true;
 			while (failure) {
 				T old = 0;
@@ -373,6 +583,7 @@ public:
 					// The header changed, we need to undo our write and try again.
 					write_block.get_cell(index).store(0, std::memory_order_relaxed);
 					// We do NOT unclaim the block's bit here, readers handle empty blocks by themselves.
+					backoff();
 				}
 			}
 
@@ -384,6 +595,7 @@ public:
 			std::uint64_t ei = header->load(std::memory_order_relaxed);
 			std::uint64_t index;
 
+			BACKOFF backoff;
 			while (true) {
 				if (epoch_valid(get_epoch(ei), read_epoch)) {
 					if ((index = get_read_index(ei)) + 1 == get_write_index(ei)) {
@@ -396,6 +608,8 @@ public:
 							break;
 						}
 					}
+					// Only reached if another reader beat us to the header.
+					backoff();
 				}
 				if (!claim_new_block_read()) {
 					return std::nullopt;
@@ -0,0 +1,189 @@
+#ifndef BLOCK_BASED_QUEUE_TUNING_H_INCLUDED
+#define BLOCK_BASED_QUEUE_TUNING_H_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "block_based_queue.h"
+
+#ifndef BBQ_TUNING_FILE
+#define BBQ_TUNING_FILE "bbq_tuning.csv"
+#endif
+
+struct block_based_queue_parameters {
+	double blocks_per_window_per_thread;
+	std::size_t cells_per_block;
+};
+
+// Picks blocks_per_window_per_thread and cells_per_block for the current host by briefly benchmarking
+// a reduced version of the parameter tuning grid. Results are cached per process and in BBQ_TUNING_FILE
+// (overridable at runtime via the environment variable of the same name), so only the first construction
+// for a given thread count pays for the calibration.
+template <typename T, typename BITSET_T = std::uint8_t>
+class block_based_queue_tuning {
+private:
+	// Subset of the offline sweep in config.hpp; cells per block is one less than a power of two
+	// so that a block including its header fills whole cache lines.
+	static constexpr std::array<double, 5> candidate_blocks = { 0.5, 1, 2, 4, 8 };
+	static constexpr std::array<std::size_t, 4> candidate_cells = { 7, 31, 127, 511 };
+
+	// Candidates are first measured for the short duration, the best ones are then measured again for the long one.
+	static constexpr std::chrono::milliseconds short_duration{ 25 };
+	static constexpr std::chrono::milliseconds long_duration{ 100 };
+	static constexpr std::size_t finalists = 4;
+
+	// Calibration speed matters more than matching the real size exactly.
+	static constexpr std::size_t max_calibration_size = 1 << 22;
+
+	using key_t = std::tuple<int, std::size_t, std::size_t>;
+
+	static inline std::mutex mutex;
+	static inline std::map<key_t, block_based_queue_parameters> cache;
+	// Makes concurrent get() calls for the same key share a single calibration.
+	static inline std::map<key_t, std::once_flag> calibrations;
+	static inline bool file_loaded = false;
+
+	static key_t make_key(int thread_count) {
+		return { thread_count, sizeof(T), sizeof(BITSET_T) };
+	}
+
+	static std::string cache_file() {
+		const char* env = std::getenv("BBQ_TUNING_FILE");
+		return env != nullptr ? env : BBQ_TUNING_FILE;
+	}
+
+	// Later lines win, so a re-calibration appended to the file overrides the earlier result.
+	static void load_file() {
+		std::ifstream file{ cache_file() };
+		std::string line;
+		while (std::getline(file, line)) {
+			std::istringstream stream{ line };
+			int thread_count;
+			std::size_t elem_size, bitset_size;
+			block_based_queue_parameters params;
+			char sep;
+			if (stream >> thread_count >> sep >> elem_size >> sep >> bitset_size >> sep
+					>> params.blocks_per_window_per_thread >> sep >> params.cells_per_block) {
+				cache.insert_or_assign({ thread_count, elem_size, bitset_size }, params);
+			}
+		}
+	}
+
+	static void append_file(int thread_count, const block_based_queue_parameters& params) {
+		std::ofstream file{ cache_file(), std::ios::app };
+		file << thread_count << ',' << sizeof(T) << ',' << sizeof(BITSET_T) << ','
+			<< params.blocks_per_window_per_thread << ',' << params.cells_per_block << '\n';
+	}
+
+public:
+	// Alternating push/pop throughput (operations per second) of a queue half filled in advance.
+	static double measure(int thread_count, std::size_t min_size, const block_based_queue_parameters& params, std::chrono::milliseconds duration) {
+		block_based_queue<T, BITSET_T> queue{ thread_count, min_size, params.blocks_per_window_per_thread, params.cells_per_block };
+		std::barrier a{ thread_count + 1 };
+		std::atomic_bool over = false;
+		std::vector<std::size_t> results(thread_count);
+		std::vector<std::jthread> threads(thread_count);
+		for (int i = 0; i < thread_count; i++) {
+			threads[i] = std::jthread([&, i]() {
+				auto handle = queue.get_handle();
+				for (std::size_t j = 0; j < min_size / 2 / thread_count; j++) {
+					if (!handle.push(static_cast<T>(j + 1))) {
+						break;
+					}
+				}
+				std::size_t its = 0;
+				a.arrive_and_wait();
+				while (!over.load(std::memory_order_relaxed)) {
+					handle.push(static_cast<T>(5));
+					handle.pop();
+					its++;
+				}
+				results[i] = its;
+			});
+		}
+		a.arrive_and_wait();
+		auto start = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(duration);
+		over = true;
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::size_t total = 0;
+		for (auto r : results) {
+			total += r;
+		}
+		return total / seconds;
+	}
+
+	// Always runs the calibration, bypassing (and updating) the cache.
+	static block_based_queue_parameters calibrate(int thread_count, std::size_t min_size) {
+		min_size = std::min(min_size, max_calibration_size);
+
+		std::vector<std::pair<double, block_based_queue_parameters>> results;
+		for (double b : candidate_blocks) {
+			for (std::size_t c : candidate_cells) {
+				block_based_queue_parameters params{ b, c };
+				results.emplace_back(measure(thread_count, min_size, params, short_duration), params);
+			}
+		}
+
+		auto by_throughput = [](const auto& a, const auto& b) { return a.first > b.first; };
+		std::sort(results.begin(), results.end(), by_throughput);
+		results.resize(std::min(finalists, results.size()));
+		for (auto& [throughput, params] : results) {
+			throughput = measure(thread_count, min_size, params, long_duration);
+		}
+		auto best = std::min_element(results.begin(), results.end(), by_throughput)->second;
+
+		std::scoped_lock lock{ mutex };
+		cache.insert_or_assign(make_key(thread_count), best);
+		append_file(thread_count, best);
+		return best;
+	}
+
+	static block_based_queue_parameters get(int thread_count, std::size_t min_size) {
+		std::once_flag* calibration;
+		{
+			std::scoped_lock lock{ mutex };
+			if (!file_loaded) {
+				load_file();
+				file_loaded = true;
+			}
+			if (auto it = cache.find(make_key(thread_count)); it != cache.end()) {
+				return it->second;
+			}
+			calibration = &calibrations[make_key(thread_count)];
+		}
+		std::call_once(*calibration, [&]() { calibrate(thread_count, min_size); });
+		std::scoped_lock lock{ mutex };
+		return cache.at(make_key(thread_count));
+	}
+};
+
+// Block-based queue which picks its parameters via block_based_queue_tuning on construction.
+template <typename T, typename BITSET_T = std::uint8_t>
+class tuned_block_based_queue : public block_based_queue<T, BITSET_T> {
+private:
+	tuned_block_based_queue(int thread_count, std::size_t min_size, const block_based_queue_parameters& params) :
+		block_based_queue<T, BITSET_T>(thread_count, min_size, params.blocks_per_window_per_thread, params.cells_per_block) { }
+
+public:
+	tuned_block_based_queue(int thread_count, std::size_t min_size) :
+		tuned_block_based_queue(thread_count, min_size, block_based_queue_tuning<T, BITSET_T>::get(thread_count, min_size)) { }
+};
+static_assert(fifo<tuned_block_based_queue<std::uint64_t>, std::uint64_t>);
+
+#endif // BLOCK_BASED_QUEUE_TUNING_H_INCLUDED
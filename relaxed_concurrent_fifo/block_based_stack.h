@@ -0,0 +1,260 @@
+#ifndef BLOCK_BASED_STACK_H_INCLUDED
+#define BLOCK_BASED_STACK_H_INCLUDED
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+
+#include "fifo.h"
+#include "atomic_bitset_no_epoch.h"
+#include "block_based_queue.h"
+
+#if defined(__GNUC__) && defined(unix)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+
+// Relaxed LIFO sibling of block_based_queue. Windows are stacked on top of each other instead of being used
+// as a ring: Pushes go to the top window and only move up once all of its blocks are full, pops take from the
+// top window and move down once it is empty. Within a block, cells are used as a stack as well.
+// As windows are never reused in a different role, no epochs are needed and the block header is just a count.
+// Both bitsets are hints only, correctness follows from the header and cell CASes alone:
+// full_set marks blocks pushers should skip, filled_set marks blocks poppers should look at.
+template <typename T, typename BITSET_T = std::uint8_t>
+class block_based_stack {
+private:
+	std::size_t blocks_per_window;
+	std::uniform_int_distribution<int> window_block_distribution;
+
+	std::size_t window_count;
+
+	std::size_t cells_per_block;
+	std::size_t block_size;
+
+	using block_t = block<T>;
+
+	// The buffer is allocated in units of this, so that blocks start on their own cache lines.
+	struct alignas(std::hardware_destructive_interference_size) buffer_unit {
+		std::byte bytes[std::hardware_destructive_interference_size];
+	};
+
+	atomic_bitset_no_epoch<BITSET_T> full_set;
+	atomic_bitset_no_epoch<BITSET_T> filled_set;
+	std::unique_ptr<buffer_unit[]> buffer;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t top_window = 0;
+
+	static constexpr std::size_t no_block = std::numeric_limits<std::size_t>::max();
+
+	block_t get_block(std::uint64_t window_index, std::uint64_t block_index) {
+		return reinterpret_cast<std::byte*>(buffer.get()) + (window_index * blocks_per_window + block_index) * block_size;
+	}
+
+	void raise_top_window(std::uint64_t window_index) {
+		std::uint64_t top = top_window.load(std::memory_order_seq_cst);
+		while (top < window_index && !top_window.compare_exchange_weak(top, window_index, std::memory_order_seq_cst)) { }
+	}
+
+	// Lowers the filled hint of a block seen empty. A concurrent push might have filled it again right before,
+	// so the header is checked once more after resetting; the push in turn checks the hint after its header update.
+	void reset_filled(std::uint64_t window_index, std::size_t block_index) {
+		filled_set.reset(window_index, block_index, std::memory_order_seq_cst);
+		if (get_block(window_index, block_index).get_header().load(std::memory_order_seq_cst) != 0) {
+			filled_set.set(window_index, block_index, std::memory_order_seq_cst);
+		}
+	}
+
+	bool try_push(std::uint64_t window_index, std::size_t block_index, T t) {
+		block_t block = get_block(window_index, block_index);
+		std::atomic_uint64_t& header = block.get_header();
+		std::uint64_t count = header.load(std::memory_order_seq_cst);
+		while (true) {
+			if (count == cells_per_block) {
+				full_set.set(window_index, block_index, std::memory_order_relaxed);
+				return false;
+			}
+			// A non-zero cell is either about to be taken by a pop or held by a push that has not updated the header yet.
+			std::uint64_t index = count;
+			T old = 0;
+			if (!block.get_cell(index).compare_exchange_strong(old, t, std::memory_order_relaxed)) {
+				count = header.load(std::memory_order_seq_cst);
+				continue;
+			}
+			if (header.compare_exchange_strong(count, index + 1, std::memory_order_seq_cst)) {
+				break;
+			}
+			// The header changed, undo our write and try again.
+			block.get_cell(index).store(0, std::memory_order_relaxed);
+		}
+		filled_set.set(window_index, block_index, std::memory_order_seq_cst);
+		// Pairs with the recheck after a pop lowered the top window.
+		raise_top_window(window_index);
+		return true;
+	}
+
+	std::optional<T> try_pop(std::uint64_t window_index, std::size_t block_index) {
+		block_t block = get_block(window_index, block_index);
+		std::atomic_uint64_t& header = block.get_header();
+		std::uint64_t count = header.load(std::memory_order_seq_cst);
+		do {
+			if (count == 0) {
+				reset_filled(window_index, block_index);
+				return std::nullopt;
+			}
+		} while (!header.compare_exchange_weak(count, count - 1, std::memory_order_seq_cst));
+
+		// The push into this cell wrote it before updating the header.
+		T ret = block.get_cell(count - 1).exchange(0, std::memory_order_relaxed);
+		assert(ret != 0);
+		if (count == cells_per_block) {
+			full_set.reset(window_index, block_index, std::memory_order_relaxed);
+		}
+		if (count == 1) {
+			reset_filled(window_index, block_index);
+		}
+		return ret;
+	}
+
+public:
+	block_based_stack(int thread_count, std::size_t min_size, double blocks_per_window_per_thread, std::size_t cells_per_block) :
+			blocks_per_window(std::bit_ceil(std::max<std::size_t>(sizeof(BITSET_T) * 8,
+				std::lround(thread_count * blocks_per_window_per_thread)))),
+			window_block_distribution(0, static_cast<int>(blocks_per_window - 1)),
+			window_count(std::max<std::size_t>(1, (min_size + blocks_per_window * cells_per_block - 1) / (blocks_per_window * cells_per_block))),
+			cells_per_block(cells_per_block),
+			block_size(align_block_size(sizeof(std::atomic_uint64_t) + cells_per_block * sizeof(T), sizeof(buffer_unit))),
+			full_set(window_count, blocks_per_window),
+			filled_set(window_count, blocks_per_window),
+			buffer(std::make_unique<buffer_unit[]>(window_count * blocks_per_window * block_size / sizeof(buffer_unit))) {
+		for (std::size_t i = 0; i < window_count * blocks_per_window; i++) {
+			auto ptr = reinterpret_cast<std::byte*>(buffer.get()) + i * block_size;
+			new (ptr) std::atomic_uint64_t{ 0 };
+			for (std::size_t j = 0; j < cells_per_block; j++) {
+				new (ptr + sizeof(std::atomic_uint64_t) + j * sizeof(T)) std::atomic<T>{ };
+			}
+		}
+	}
+
+	std::size_t capacity() const {
+		return window_count * blocks_per_window * cells_per_block;
+	}
+
+	std::size_t size() {
+		std::size_t filled_cells = 0;
+		for (std::size_t i = 0; i < window_count; i++) {
+			for (std::size_t j = 0; j < blocks_per_window; j++) {
+				filled_cells += get_block(i, j).get_header().load();
+			}
+		}
+		return filled_cells;
+	}
+
+	class handle {
+	private:
+		block_based_stack& stack;
+
+		// The block we last pushed to is also the first one we pop from, as it holds the most recent elements.
+		std::uint64_t write_window = 0;
+		std::size_t write_block = no_block;
+		std::uint64_t read_window = 0;
+		std::size_t read_block = no_block;
+
+		std::minstd_rand rng;
+
+		handle(block_based_stack& stack, std::random_device::result_type seed) : stack(stack), rng(seed) { }
+
+		friend block_based_stack;
+
+		int random_bit_index() {
+			return stack.window_block_distribution(rng);
+		}
+
+	public:
+		bool push(T t) {
+			assert(t != 0);
+
+			while (true) {
+				std::uint64_t window_index = stack.top_window.load(std::memory_order_relaxed);
+				// The cached block is only used while its window is still the top one.
+				if (write_block != no_block && write_window == window_index && stack.try_push(write_window, write_block, t)) {
+					return true;
+				}
+
+				std::size_t free_bit = stack.full_set.template claim_bit<claim_value::ZERO, claim_mode::READ_ONLY>(
+					window_index, random_bit_index(), std::memory_order_relaxed);
+				if (free_bit != std::numeric_limits<std::size_t>::max()) {
+					write_window = window_index;
+					write_block = free_bit;
+					if (stack.try_push(write_window, write_block, t)) {
+						return true;
+					}
+					continue;
+				}
+
+				if (window_index + 1 == stack.window_count) {
+					return false;
+				}
+				stack.top_window.compare_exchange_strong(window_index, window_index + 1, std::memory_order_seq_cst);
+			}
+		}
+
+		std::optional<T> pop() {
+			std::uint64_t window_index = stack.top_window.load(std::memory_order_seq_cst);
+			if (write_block != no_block && write_window == window_index) {
+				if (auto ret = stack.try_pop(write_window, write_block); ret.has_value()) {
+					return ret;
+				}
+			}
+
+			while (true) {
+				if (read_block != no_block && read_window == window_index) {
+					if (auto ret = stack.try_pop(read_window, read_block); ret.has_value()) {
+						return ret;
+					}
+				}
+
+				std::size_t filled_bit = stack.filled_set.template claim_bit<claim_value::ONE, claim_mode::READ_ONLY>(
+					window_index, random_bit_index(), std::memory_order_seq_cst);
+				if (filled_bit != std::numeric_limits<std::size_t>::max()) {
+					read_window = window_index;
+					read_block = filled_bit;
+					if (auto ret = stack.try_pop(read_window, read_block); ret.has_value()) {
+						return ret;
+					}
+					read_block = no_block;
+					window_index = stack.top_window.load(std::memory_order_seq_cst);
+					continue;
+				}
+
+				if (window_index == 0) {
+					return std::nullopt;
+				}
+
+				// Move down, unless a push into the window we left raced with us.
+				std::uint64_t expected = window_index;
+				stack.top_window.compare_exchange_strong(expected, window_index - 1, std::memory_order_seq_cst);
+				if (stack.filled_set.template claim_bit<claim_value::ONE, claim_mode::READ_ONLY>(
+						window_index, 0, std::memory_order_seq_cst) != std::numeric_limits<std::size_t>::max()) {
+					stack.raise_top_window(window_index);
+				}
+				window_index = stack.top_window.load(std::memory_order_seq_cst);
+			}
+		}
+	};
+
+	handle get_handle() { return handle(*this, std::random_device()()); }
+};
+static_assert(fifo<block_based_stack<std::uint64_t>, std::uint64_t>);
+
+#if defined(__GNUC__) && defined(unix)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // BLOCK_BASED_STACK_H_INCLUDED
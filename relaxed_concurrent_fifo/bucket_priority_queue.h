@@ -0,0 +1,114 @@
+#ifndef BUCKET_PRIORITY_QUEUE_H_INCLUDED
+#define BUCKET_PRIORITY_QUEUE_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <vector>
+
+#include "fifo.h"
+#include "block_based_queue.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif // __GNUC__
+
+// Relaxed priority queue made of one block-based queue per band of priorities_per_bucket consecutive priorities.
+// The priority of an element is stored in its upper 32 bits, smaller priorities are popped first.
+// Priorities beyond the last band all end up in the last bucket.
+// Pops start at the lowest non-empty bucket hint. The hint is lowered by pushes and raised by pops that find lower
+// buckets empty; since both race, a pop falls back to scanning the buckets below the hint before reporting emptiness.
+// Within a bucket, elements are only as ordered as the block-based queue keeps them.
+template <typename T = std::uint64_t, typename BITSET_T = std::uint8_t>
+class bucket_priority_queue {
+private:
+	using bucket_t = block_based_queue<T, BITSET_T>;
+
+	std::vector<std::unique_ptr<bucket_t>> buckets;
+	std::uint64_t priorities_per_bucket;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_size_t lowest_bucket_hint = 0;
+
+	std::size_t bucket_of(T t) const {
+		return std::min<std::size_t>((static_cast<std::uint64_t>(t) >> 32) / priorities_per_bucket, buckets.size() - 1);
+	}
+
+	void lower_hint(std::size_t bucket) {
+		std::size_t hint = lowest_bucket_hint.load(std::memory_order_relaxed);
+		while (bucket < hint && !lowest_bucket_hint.compare_exchange_weak(hint, bucket, std::memory_order_relaxed)) { }
+	}
+
+public:
+	// Every bucket gets twice its share of size, leaving some slack for unevenly distributed priorities.
+	bucket_priority_queue(int thread_count, std::size_t size, int bucket_count, std::uint64_t priorities_per_bucket,
+		double blocks_per_window_per_thread, std::size_t cells_per_block) : priorities_per_bucket(priorities_per_bucket) {
+		buckets.reserve(bucket_count);
+		for (int i = 0; i < bucket_count; i++) {
+			buckets.push_back(std::make_unique<bucket_t>(thread_count, size / bucket_count * 2, blocks_per_window_per_thread, cells_per_block));
+		}
+	}
+
+	std::size_t bucket_count() const {
+		return buckets.size();
+	}
+
+	class handle {
+	private:
+		bucket_priority_queue& pq;
+		std::vector<typename bucket_t::handle> bucket_handles;
+
+		handle(bucket_priority_queue& pq) : pq(pq) {
+			bucket_handles.reserve(pq.buckets.size());
+			for (auto& bucket : pq.buckets) {
+				bucket_handles.push_back(bucket->get_handle());
+			}
+		}
+
+		friend bucket_priority_queue;
+
+	public:
+		bool push(T t) {
+			std::size_t bucket = pq.bucket_of(t);
+			if (!bucket_handles[bucket].push(t)) {
+				return false;
+			}
+			pq.lower_hint(bucket);
+			return true;
+		}
+
+		std::optional<T> pop() {
+			std::size_t hint = pq.lowest_bucket_hint.load(std::memory_order_relaxed);
+			for (std::size_t i = hint; i < bucket_handles.size(); i++) {
+				if (auto ret = bucket_handles[i].pop(); ret.has_value()) {
+					if (i != hint) {
+						// Only raise the hint if nobody else changed it in the meantime.
+						pq.lowest_bucket_hint.compare_exchange_strong(hint, i, std::memory_order_relaxed);
+					}
+					return ret;
+				}
+			}
+
+			// A push into a lower bucket might have raced with a pop raising the hint.
+			for (std::size_t i = 0; i < std::min(hint, bucket_handles.size()); i++) {
+				if (auto ret = bucket_handles[i].pop(); ret.has_value()) {
+					pq.lower_hint(i);
+					return ret;
+				}
+			}
+			return std::nullopt;
+		}
+	};
+
+	handle get_handle() { return handle(*this); }
+};
+static_assert(fifo<bucket_priority_queue<std::uint64_t>, std::uint64_t>);
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#endif // BUCKET_PRIORITY_QUEUE_H_INCLUDED
@@ -7,6 +7,7 @@
 #include <regex>
 
 #include "benchmark.h"
+#include "lock_fifo.h"
 
 #if defined(__GNUC__) && defined(unix) && !(defined(__arm__) || defined(__aarch64__))
 #pragma GCC diagnostic push
@@ -23,6 +24,9 @@ using LCRQWrapped = LCRQueue<T>;
 
 // By default, include all.
 #if !defined(INCLUDE_BBQ) \
+	&& !defined(INCLUDE_BBQ_HUGEPAGE) \
+	&& !defined(INCLUDE_BBQ_TUNED) \
+	&& !defined(INCLUDE_BBS) \
 	&& !defined(INCLUDE_MULTIFIFO) \
 	&& !defined(INCLUDE_LCRQ) \
 	&& !defined(INCLUDE_FAAAQUEUE) \
@@ -37,6 +41,32 @@ using LCRQWrapped = LCRQueue<T>;
 #undef INCLUDE_ALL
 #endif
 
+template <typename BENCHMARK>
+static void filter_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, std::unordered_set<std::string>& filter_set, bool are_exclude_filters) {
+	for (std::size_t i = 0; i < instances.size(); i++) {
+		const std::string& name = instances[i]->get_name();
+		bool any_match = false;
+		std::smatch m;
+		for (const std::string& filter : filter_set) {
+			if (std::regex_match(name, m, std::regex{filter})) {
+				any_match = true;
+				break;
+			}
+		}
+		if (any_match == are_exclude_filters) {
+			instances.erase(instances.begin() + i);
+			i--;
+		}
+	}
+}
+
+// Relaxed stacks, only included in the FIFO benchmarks on request.
+template <typename BENCHMARK>
+static void add_stack_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances) {
+	instances.push_back(std::make_unique<benchmark_provider_bbs<BENCHMARK>>("blockstack-{}-{}", 1, 7));
+	instances.push_back(std::make_unique<benchmark_provider_bbs<BENCHMARK>>("blockstack-{}-{}", 1, 63));
+}
+
 template <typename BENCHMARK>
 static void add_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, bool parameter_tuning, std::unordered_set<std::string>& filter_set, bool are_exclude_filters) {
 #if defined(INCLUDE_BBQ) || defined(INCLUDE_ALL)
@@ -53,6 +83,19 @@ static void add_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMA
 	}
 #endif
 
+#if defined(INCLUDE_BBQ_TUNED)/* || defined(INCLUDE_ALL)*/
+	// Calibrates on first construction for each thread count, which happens outside of the measured time.
+	instances.push_back(std::make_unique<benchmark_provider_bbq_tuned<BENCHMARK>>("blockfifo-tuned"));
+#endif
+
+#if defined(INCLUDE_BBQ_HUGEPAGE)/* || defined(INCLUDE_ALL)*/
+	instances.push_back(std::make_unique<benchmark_provider_bbq_hugepage<BENCHMARK>>("blockfifo-hugepage-{}-{}", 1, 63));
+#endif
+
+#if defined(INCLUDE_BBS)/* || defined(INCLUDE_ALL)*/
+	add_stack_instances(instances);
+#endif
+
 #if defined(INCLUDE_MULTIFIFO) || defined(INCLUDE_ALL)
 	if (parameter_tuning) {
 		for (int queues_per_thread = 2; queues_per_thread <= 8; queues_per_thread *= 2) {
@@ -107,21 +150,41 @@ static void add_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMA
     instances.push_back(std::make_unique<benchmark_provider_faaaqueue<BENCHMARK>>("faaaqueue"));
 #endif
 
-	for (std::size_t i = 0; i < instances.size(); i++) {
-		const std::string& name = instances[i]->get_name();
-		bool any_match = false;
-		std::smatch m;
-		for (const std::string& filter : filter_set) {
-			if (std::regex_match(name, m, std::regex{filter})) {
-				any_match = true;
-				break;
-			}
-		}
-		if (any_match == are_exclude_filters) {
-			instances.erase(instances.begin() + i);
-			i--;
-		}
+	filter_instances(instances, filter_set, are_exclude_filters);
+}
+
+// Relaxed priority queues, with a priority-oblivious block-based queue as baseline.
+template <typename BENCHMARK>
+static void add_priority_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, std::unordered_set<std::string>& filter_set, bool are_exclude_filters) {
+	constexpr auto priority_count = pq_element_generator::PRIORITY_COUNT;
+	for (int buckets = 64; buckets <= 1024; buckets *= 4) {
+		instances.push_back(std::make_unique<benchmark_provider_bucket_pq<BENCHMARK>>("bucketpq-{}-{}-{}-{}", buckets, priority_count / buckets, 1, 63));
 	}
+	instances.push_back(std::make_unique<benchmark_provider_bbq<BENCHMARK>>("blockfifo-{}-{}", 1, 63));
+
+	filter_instances(instances, filter_set, are_exclude_filters);
+}
+
+template <typename BENCHMARK>
+static void add_backoff_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, std::unordered_set<std::string>& filter_set, bool are_exclude_filters) {
+	for (std::size_t c : { 7, 63 }) {
+		instances.push_back(std::make_unique<benchmark_provider_bbq_backoff<BENCHMARK, backoff_none>>("blockfifo-none-{}-{}", 1, c));
+		instances.push_back(std::make_unique<benchmark_provider_bbq_backoff<BENCHMARK, backoff_pause>>("blockfifo-pause-{}-{}", 1, c));
+		instances.push_back(std::make_unique<benchmark_provider_bbq_backoff<BENCHMARK, backoff_exponential<>>>("blockfifo-exponential-{}-{}", 1, c));
+		instances.push_back(std::make_unique<benchmark_provider_bbq_backoff<BENCHMARK, backoff_yield>>("blockfifo-yield-{}-{}", 1, c));
+	}
+
+	filter_instances(instances, filter_set, are_exclude_filters);
+}
+
+// Shared queues of the work-stealing pool, with a mutex-protected queue as baseline.
+template <typename BENCHMARK>
+static void add_pool_instances(std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, std::unordered_set<std::string>& filter_set, bool are_exclude_filters) {
+	instances.push_back(std::make_unique<benchmark_provider_bbq<BENCHMARK>>("blockfifo-{}-{}", 1, 63));
+	instances.push_back(std::make_unique<benchmark_provider_multififo<BENCHMARK>>("multififo-{}-{}", 2, 1));
+	instances.push_back(std::make_unique<benchmark_provider_generic<lock_fifo<std::uint64_t>, BENCHMARK>>("lock"));
+
+	filter_instances(instances, filter_set, are_exclude_filters);
 }
 
 #endif // CONFIG_H_INCLUDED
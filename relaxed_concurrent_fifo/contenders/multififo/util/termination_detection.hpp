@@ -10,6 +10,11 @@
 
 namespace termination_detection {
 
+struct NoBackoff {
+    void operator()() {
+    }
+};
+
 class TerminationDetection {
     int num_threads_;
     std::atomic_int idle_count_{0};
@@ -33,8 +38,9 @@ class TerminationDetection {
 
     TerminationDetection(TerminationDetection&&) {}
 
-    template <typename F>
-    bool repeat(F&& f) {
+    // backoff is invoked after every unsuccessful retry of f.
+    template <typename F, typename Backoff = NoBackoff>
+    bool repeat(F&& f, Backoff backoff = {}) {
         if (f()) {
             return true;
         }
@@ -45,6 +51,7 @@ class TerminationDetection {
                     return false;
                 }
             }
+            backoff();
         }
         no_work_count_.fetch_sub(1, std::memory_order_relaxed);
         return true;
@@ -0,0 +1,162 @@
+#ifndef DELAY_QUEUE_H_INCLUDED
+#define DELAY_QUEUE_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <vector>
+
+#include "block_based_queue.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif // __GNUC__
+
+// Timer wheel of slot_count compact block-based queues, each collecting the elements of one time slot.
+// An element with a deadline in (slot - 1, slot] (in units of slot_duration since construction) is stored in
+// slot, which expires once the current time reaches it, so elements are never returned before their deadline.
+// Pops drain the oldest expired slot (with the relaxed ordering of block_based_queue inside it) and move the
+// shared read slot on once it is empty. Deadlines in the past go to the read slot, deadlines further than
+// slot_count - 1 slots ahead of it are rejected.
+// Elements are limited to 48 bits, the upper 16 bits tag them with their slot. This way, a pop with an outdated
+// read slot recognizes an element of the next wheel revolution and puts it back instead of returning it early.
+// A push racing with the read slot moving past its slot is caught by the popper rechecking the slot after moving on;
+// only if the push lands after that recheck is the element delivered late, one wheel revolution later.
+class delay_queue {
+public:
+	using clock = std::chrono::steady_clock;
+
+	static constexpr int payload_bits = 48;
+	static constexpr std::uint64_t payload_mask = (1ull << payload_bits) - 1;
+
+private:
+	using slot_queue_t = block_based_queue<std::uint64_t, std::uint8_t, std::allocator<std::byte>, true>;
+
+	std::vector<std::unique_ptr<slot_queue_t>> slots;
+	std::uint64_t slot_count_mod_mask;
+	clock::duration slot_duration;
+	clock::time_point start;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t read_slot = 0;
+
+	std::uint64_t current_slot(clock::time_point now) const {
+		return now < start ? 0 : (now - start) / slot_duration;
+	}
+
+	std::uint64_t deadline_slot(clock::time_point deadline) const {
+		return deadline <= start ? 0 : ((deadline - start) + slot_duration - clock::duration{ 1 }) / slot_duration;
+	}
+
+	// The full slot of a tag, as seen from a slot less than half the tag range away.
+	static std::uint64_t tag_to_slot(std::uint64_t value, std::uint64_t reference) {
+		return reference + static_cast<std::int16_t>((value >> payload_bits) - reference);
+	}
+
+public:
+	// slot_count has to be a power of two, every slot gets twice its share of size.
+	delay_queue(int thread_count, std::size_t size, std::size_t slot_count, clock::duration slot_duration,
+		double blocks_per_window_per_thread, std::size_t cells_per_block) :
+			slot_count_mod_mask(slot_count - 1),
+			slot_duration(slot_duration),
+			start(clock::now()) {
+		assert(std::has_single_bit(slot_count));
+		// Tags must tell apart slots across more than one revolution.
+		assert(slot_count <= 1 << 14);
+		slots.reserve(slot_count);
+		for (std::size_t i = 0; i < slot_count; i++) {
+			slots.push_back(std::make_unique<slot_queue_t>(thread_count, size / slot_count * 2, blocks_per_window_per_thread, cells_per_block));
+		}
+	}
+
+	clock::time_point start_time() const {
+		return start;
+	}
+
+	// Latest deadline currently accepted by push.
+	clock::time_point horizon() const {
+		return start + slot_duration * (read_slot.load(std::memory_order_relaxed) + slots.size() - 1);
+	}
+
+	class handle {
+	private:
+		delay_queue& queue;
+		std::vector<typename slot_queue_t::handle> slot_handles;
+
+		handle(delay_queue& queue) : queue(queue) {
+			slot_handles.reserve(queue.slots.size());
+			for (auto& slot : queue.slots) {
+				slot_handles.push_back(slot->get_handle());
+			}
+		}
+
+		friend delay_queue;
+
+		typename slot_queue_t::handle& slot_handle(std::uint64_t slot) {
+			return slot_handles[slot & queue.slot_count_mod_mask];
+		}
+
+		// Returns the payload if the element's slot has expired, otherwise puts it back.
+		std::optional<std::uint64_t> take(std::uint64_t value, std::uint64_t read, std::uint64_t now_slot) {
+			std::uint64_t slot = tag_to_slot(value, read);
+			if (slot <= now_slot) {
+				return value & payload_mask;
+			}
+			slot_handle(slot).push(value);
+			return std::nullopt;
+		}
+
+	public:
+		bool push(std::uint64_t t, clock::time_point deadline) {
+			assert(t != 0 && t <= payload_mask);
+			std::uint64_t read = queue.read_slot.load(std::memory_order_relaxed);
+			std::uint64_t slot = std::max(queue.deadline_slot(deadline), read);
+			if (slot - read >= queue.slots.size()) {
+				return false;
+			}
+			return slot_handle(slot).push(((slot & 0xffff) << payload_bits) | t);
+		}
+
+		// Returns an element whose deadline has passed at time now, if there is one.
+		std::optional<std::uint64_t> pop(clock::time_point now = clock::now()) {
+			std::uint64_t now_slot = queue.current_slot(now);
+			std::uint64_t read = queue.read_slot.load(std::memory_order_relaxed);
+			while (read <= now_slot) {
+				if (auto ret = slot_handle(read).pop(); ret.has_value()) {
+					if (auto payload = take(*ret, read, now_slot); payload.has_value()) {
+						return payload;
+					}
+					// Only possible if the read slot moved on in the meantime.
+					read = queue.read_slot.load(std::memory_order_relaxed);
+					continue;
+				}
+				// The current slot can still receive elements with earlier deadlines, so we stay on it.
+				if (read == now_slot) {
+					break;
+				}
+				if (queue.read_slot.compare_exchange_strong(read, read + 1, std::memory_order_seq_cst)) {
+					// Pushes which read the old read slot may still be landing in the slot we left.
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (auto ret = slot_handle(read).pop(); ret.has_value()) {
+						if (auto payload = take(*ret, read, now_slot); payload.has_value()) {
+							return payload;
+						}
+					}
+					read++;
+				}
+			}
+			return std::nullopt;
+		}
+	};
+
+	handle get_handle() { return handle(*this); }
+};
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#endif // DELAY_QUEUE_H_INCLUDED
@@ -0,0 +1,121 @@
+#ifndef HUGEPAGE_ARENA_H_INCLUDED
+#define HUGEPAGE_ARENA_H_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif // __linux__
+
+// Bump allocator handing out memory from large chunks backed by huge pages.
+// Chunks are mapped with MAP_HUGETLB if the system has reserved huge pages, otherwise
+// transparent huge pages are requested via madvise. Memory is only returned on destruction.
+class hugepage_arena {
+private:
+	static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+	struct chunk {
+		std::byte* ptr;
+		std::size_t size;
+		bool hugetlb;
+	};
+
+	std::size_t chunk_size;
+	std::vector<chunk> chunks;
+	std::size_t used = 0;
+	std::mutex mut;
+
+	static constexpr std::size_t round_up(std::size_t size, std::size_t alignment) {
+		return (size + alignment - 1) / alignment * alignment;
+	}
+
+	void map_chunk(std::size_t min_size) {
+		std::size_t size = round_up(std::max(chunk_size, min_size), huge_page_size);
+#ifdef __linux__
+		bool hugetlb = true;
+		void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (ptr == MAP_FAILED) {
+			hugetlb = false;
+			ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (ptr == MAP_FAILED) {
+				throw std::bad_alloc();
+			}
+			madvise(ptr, size, MADV_HUGEPAGE);
+		}
+		chunks.push_back({ static_cast<std::byte*>(ptr), size, hugetlb });
+#else
+		chunks.push_back({ static_cast<std::byte*>(::operator new(size, std::align_val_t{ huge_page_size })), size, false });
+#endif // __linux__
+		used = 0;
+	}
+
+public:
+	explicit hugepage_arena(std::size_t chunk_size = 64 * huge_page_size) : chunk_size(chunk_size) { }
+
+	~hugepage_arena() {
+		for (auto& c : chunks) {
+#ifdef __linux__
+			munmap(c.ptr, c.size);
+#else
+			::operator delete(c.ptr, std::align_val_t{ huge_page_size });
+#endif // __linux__
+		}
+	}
+
+	hugepage_arena(const hugepage_arena&) = delete;
+	hugepage_arena& operator=(const hugepage_arena&) = delete;
+
+	void* allocate(std::size_t size, std::size_t alignment) {
+		std::scoped_lock lock(mut);
+		if (chunks.empty() || round_up(used, alignment) + size > chunks.back().size) {
+			map_chunk(size);
+		}
+		used = round_up(used, alignment);
+		void* ret = chunks.back().ptr + used;
+		used += size;
+		return ret;
+	}
+
+	// Whether all memory is backed by reserved (MAP_HUGETLB) huge pages instead of transparent ones.
+	bool uses_hugetlb() const {
+		for (const auto& c : chunks) {
+			if (!c.hugetlb) {
+				return false;
+			}
+		}
+		return !chunks.empty();
+	}
+};
+
+template <typename T>
+class hugepage_arena_allocator {
+private:
+	template <typename U>
+	friend class hugepage_arena_allocator;
+
+	hugepage_arena* arena;
+
+public:
+	using value_type = T;
+
+	hugepage_arena_allocator(hugepage_arena& arena) : arena(&arena) { }
+
+	template <typename U>
+	hugepage_arena_allocator(const hugepage_arena_allocator<U>& other) : arena(other.arena) { }
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T*, std::size_t) { }
+
+	template <typename U>
+	bool operator==(const hugepage_arena_allocator<U>& other) const { return arena == other.arena; }
+};
+
+#endif // HUGEPAGE_ARENA_H_INCLUDED
@@ -1,6 +1,8 @@
 ﻿#include "config.hpp"
 
 #include "block_based_queue.h"
+#include "block_based_queue_tuning.h"
+#include "partitioned_fifo.h"
 
 
 #include <ranges>
@@ -83,6 +85,13 @@ std::ofstream setup_file(const std::string& test_name, double prefill, bool prin
 
 	std::string filename = std::format(format, test_name, prefill, std::chrono::round<std::chrono::seconds>(std::chrono::file_clock::now()));
 	std::ofstream file{ filename };
+	// Keep the thread to CPU mapping next to the results, so that runs from different machines can be compared.
+	std::ofstream mapping{ filename + ".pinning" };
+	thread_pinning::write_mapping(mapping);
+	if (time_series::interval.count() > 0) {
+		time_series::file = std::ofstream{ filename + ".timeseries" };
+		time_series::file << time_series::header << '\n';
+	}
 	if (print_header) {
 		// TODO: Doesn't take into account parameter tuning.
 		file << "queue,thread_count," << header << '\n';
@@ -96,7 +105,23 @@ std::ofstream setup_file(const std::string& test_name, double prefill, bool prin
 template <typename BENCHMARK, typename BENCHMARK_DATA_TYPE = benchmark_info, typename... Args>
 void run_benchmark(const std::string& test_name, const std::vector<std::unique_ptr<benchmark_provider<BENCHMARK>>>& instances, double prefill,
 	const std::vector<int>& processor_counts, int test_iterations, int test_time_seconds, bool print_header, bool quiet, const Args&... args) {
-    std::ofstream file = setup_file(test_name, prefill, print_header, BENCHMARK::header);
+	std::string header = BENCHMARK::header;
+	if constexpr (std::derived_from<BENCHMARK, latency_recorder>) {
+		if (latency_recorder::enabled()) {
+			header = header + ',' + latency_recorder::header;
+		}
+	}
+	if constexpr (requires (const BENCHMARK& b) { b.operation_count(); }) {
+		if (perf_counter_group::enabled) {
+			header = header + ',' + perf_counter_values::header();
+		}
+	}
+	if constexpr (requires (const BENCHMARK& b) { b.thread_operations(); }) {
+		if (thread_distribution::dump_per_thread) {
+			header = header + ',' + thread_distribution::per_thread_header;
+		}
+	}
+	std::ofstream file = setup_file(test_name, prefill, print_header, header);
 	run_benchmark_raw<BENCHMARK, BENCHMARK_DATA_TYPE, Args...>(file, instances, prefill, processor_counts, test_iterations, test_time_seconds,
 		quiet, args...);
 }
@@ -138,9 +163,38 @@ void run_benchmark_raw(std::ofstream& file, const std::vector<std::unique_ptr<be
 					std::cout << "With " << threads << " processors" << std::endl;
 				}
 				file << imp->get_name() << "," << threads << ',';
-				BENCHMARK_DATA_TYPE data{threads, test_time_seconds, args...};
-				imp->test(data, prefill).output(file);
+				time_series::label = std::format("{},{}", imp->get_name(), threads);
+				auto run = [&](std::ostream& out) {
+					BENCHMARK_DATA_TYPE data{threads, test_time_seconds, args...};
+					auto result = imp->test(data, prefill);
+					result.output(out);
+					if constexpr (std::derived_from<BENCHMARK, latency_recorder>) {
+						if (latency_recorder::enabled()) {
+							out << ',';
+							result.output_latency(out);
+						}
+					}
+					if constexpr (requires { result.operation_count(); }) {
+						if (perf_counter_group::enabled) {
+							out << ',';
+							result.perf_counters.output_per_operation(out, result.operation_count());
+						}
+					}
+					if constexpr (requires { result.thread_operations(); }) {
+						if (thread_distribution::dump_per_thread) {
+							out << ',';
+							thread_distribution::output_per_thread(out, result.thread_operations());
+						}
+					}
+				};
+				if (process_isolation::enabled) {
+					file << process_isolation::run(run, std::chrono::seconds{ test_time_seconds });
+				} else {
+					run(file);
+				}
 				file << '\n';
+				// Keep results of completed runs in case a later one takes down the whole process.
+				file.flush();
 			}
 		}
 	}
@@ -180,6 +234,7 @@ int main(int argc, const char** argv) {
 
 	constexpr int TEST_ITERATIONS_DEFAULT = 2;
 	constexpr int TEST_TIME_SECONDS_DEFAULT = 5;
+	constexpr int QUEUE_COUNT_DEFAULT = 10'000;
 
 	int input;
 	std::vector<std::string> seglist;
@@ -194,6 +249,25 @@ int main(int argc, const char** argv) {
 			"[6] Producer-Consumer\n"
 			"[7] BFS\n"
 			"[8] BFS multistart (weak scaling)\n"
+			"[9] BlockFIFO autotuning\n"
+			"[10] Many small queues\n"
+			"[11] BlockFIFO reuse\n"
+			"[12] BlockFIFO bulk load\n"
+			"[13] BlockFIFO snapshot\n"
+			"[14] Pollable queue (epoll)\n"
+			"[15] Partitioned queue (Zipf keys)\n"
+			"[16] Priority queue performance\n"
+			"[17] Priority queue quality\n"
+			"[18] DFS\n"
+			"[19] Delay queue\n"
+			"[20] Weighted consumption\n"
+			"[21] BlockFIFO backoff policies\n"
+			"[22] Oversubscription\n"
+			"[23] Open-loop latency\n"
+			"[24] Synthetic workload\n"
+			"[25] Pipeline\n"
+			"[26] Fork-join (fib, UTS)\n"
+			"[27] Work-stealing pool (fork-join, BFS)\n"
 			"Input: ";
 		std::string input_str;
 		getline(std::cin, input_str);
@@ -211,11 +285,21 @@ int main(int argc, const char** argv) {
 	}
 
 	if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
-		std::cout << "Usage: " << argv[0] << " <experiment_no> <graph_file>? [-h | --help] "
+		std::cout << "Usage: " << argv[0] << " (<experiment_no> <graph_file>? | --autotune) [-h | --help] "
 			"[-t | --thread_count <count>] "
 			"[-s | --test_time_seconds <count> (default " << TEST_TIME_SECONDS_DEFAULT << ")] "
 			"[-r | --run_count <count> (default " << TEST_ITERATIONS_DEFAULT << ")]"
 			"[--bfs-multistart-fixed <count>]"
+			"[--queue-count <count> (default " << QUEUE_COUNT_DEFAULT << ")]"
+			"[--elements <count>]"
+			"[--latency-sampling <interval>]"
+			"[--perf]"
+			"[--per-thread-dump]"
+			"[--time-series <interval_ms>]"
+			"[--isolate [--run-timeout <seconds> (default 600)]]"
+			"[--stages <threads>(,<threads>)+] [--stage-work <nanoseconds> (default 0)] [--source-rate <items_per_second> (default 0, unthrottled)]"
+			"[--pop-ratio <ratio> (default 0.5)] [--think-ns <nanoseconds> (default 0)] [--burst <count> (default 1)] [--roles <[pcm]+> (default m)]"
+			"[--pin <cpu>(,<cpu>)* | --pin-strategy <logical | compact | scatter | cores> | --no-pin]"
 			"[-f | --prefill <factor>]"
 			"[-p | --parameter-tuning]"
 			"[-n | --no-header]"
@@ -223,7 +307,7 @@ int main(int argc, const char** argv) {
 		return 0;
 	}
 
-	input = std::strtol(argv[1], nullptr, 10);
+	input = strcmp(argv[1], "--autotune") == 0 ? 9 : std::strtol(argv[1], nullptr, 10);
 
 	std::vector<int> processor_counts;
 	if (input == 6) {
@@ -245,8 +329,17 @@ int main(int argc, const char** argv) {
 	bool is_exclude = true;
 	bool quiet = false;
 	int bfs_multistart_fixed = -1;
-
-	for (int i = input == 7 || input == 8 ? 3 : 2; i < argc; i++) {
+	int queue_count = QUEUE_COUNT_DEFAULT;
+	std::optional<std::size_t> element_count;
+	double pop_ratio = 0.5;
+	std::uint64_t think_nanos = 0;
+	int burst = 1;
+	std::string roles = "m";
+	std::vector<int> stage_threads;
+	std::uint64_t stage_work_nanos = 0;
+	double source_rate = 0;
+
+	for (int i = input == 7 || input == 8 || input == 18 || input == 27 ? 3 : 2; i < argc; i++) {
 		if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--thread_count") == 0) {
 			i++;
 			const char* arg = argv[i];
@@ -287,6 +380,78 @@ int main(int argc, const char** argv) {
 		} else if (strcmp(argv[i], "--bfs-multistart-fixed") == 0) {
 			i++;
 			bfs_multistart_fixed = std::strtol(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--queue-count") == 0) {
+			i++;
+			queue_count = std::strtol(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--elements") == 0) {
+			i++;
+			element_count = std::strtoull(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--pop-ratio") == 0) {
+			i++;
+			pop_ratio = std::strtod(argv[i], nullptr);
+		} else if (strcmp(argv[i], "--think-ns") == 0) {
+			i++;
+			think_nanos = std::strtoull(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--burst") == 0) {
+			i++;
+			burst = std::max(1, static_cast<int>(std::strtol(argv[i], nullptr, 10)));
+		} else if (strcmp(argv[i], "--roles") == 0) {
+			i++;
+			roles = argv[i];
+			if (roles.empty() || roles.find_first_not_of("pcm") != std::string::npos) {
+				std::cerr << "Roles must consist of p (producer), c (consumer) and m (mixed)!" << std::endl;
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--stages") == 0) {
+			i++;
+			char* end = const_cast<char*>(argv[i]) - 1;
+			stage_threads.clear();
+			do {
+				stage_threads.push_back(std::max(1, static_cast<int>(std::strtol(end + 1, &end, 10))));
+			} while (*end == ',');
+			if (stage_threads.size() < 2) {
+				std::cerr << "A pipeline needs at least two stages!" << std::endl;
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--stage-work") == 0) {
+			i++;
+			stage_work_nanos = std::strtoull(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--source-rate") == 0) {
+			i++;
+			source_rate = std::strtod(argv[i], nullptr);
+		} else if (strcmp(argv[i], "--time-series") == 0) {
+			i++;
+			time_series::interval = std::chrono::milliseconds{ std::strtol(argv[i], nullptr, 10) };
+		} else if (strcmp(argv[i], "--isolate") == 0) {
+			process_isolation::enabled = true;
+		} else if (strcmp(argv[i], "--run-timeout") == 0) {
+			i++;
+			process_isolation::timeout = std::chrono::seconds{ std::strtol(argv[i], nullptr, 10) };
+		} else if (strcmp(argv[i], "--per-thread-dump") == 0) {
+			thread_distribution::dump_per_thread = true;
+		} else if (strcmp(argv[i], "--perf") == 0) {
+			perf_counter_group::enabled = true;
+		} else if (strcmp(argv[i], "--latency-sampling") == 0) {
+			i++;
+			latency_recorder::sample_interval = std::strtoull(argv[i], nullptr, 10);
+		} else if (strcmp(argv[i], "--pin") == 0) {
+			i++;
+			char* end = const_cast<char*>(argv[i]) - 1;
+			std::vector<int> cpus;
+			do {
+				cpus.push_back(std::strtol(end + 1, &end, 10));
+			} while (*end == ',');
+			thread_pinning::use_list(std::move(cpus));
+		} else if (strcmp(argv[i], "--pin-strategy") == 0) {
+			i++;
+			pinning_strategy strategy;
+			if (!parse_pinning_strategy(argv[i], strategy)) {
+				std::cerr << std::format("Unknown pinning strategy \"{}\"!", argv[i]) << std::endl;
+				return 1;
+			}
+			thread_pinning::use_strategy(strategy);
+		} else if (strcmp(argv[i], "--no-pin") == 0) {
+			thread_pinning::enabled = false;
 		} else if (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--no-header") == 0) {
 			include_header = false;
 		} else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0) {
@@ -297,6 +462,11 @@ int main(int argc, const char** argv) {
 		}
 	}
 
+	if (perf_counter_group::enabled && !perf_counter_group{}.valid()) {
+		std::cout << "Notice: Performance counters are not available, continuing without them" << std::endl;
+		perf_counter_group::enabled = false;
+	}
+
 	switch (input) {
 	case 1: {
 		std::vector<std::unique_ptr<benchmark_provider<benchmark_default>>> instances;
@@ -388,6 +558,328 @@ int main(int argc, const char** argv) {
 			run_benchmark_raw<benchmark_bfs_multistart, benchmark_info_graph_multistart, const Graph&, const std::vector<std::vector<std::uint32_t>>&>(
 				result_file, instances, 0, processor_counts, test_its, 0, quiet, graph, distances, bfs_multistart_fixed);
 	} break;
+	case 9: {
+		// Compares the short calibration of block_based_queue_tuning against the full parameter tuning sweep.
+		auto result_file = setup_file("autotune", 0.5, include_header, benchmark_default::header);
+		for (auto threads : processor_counts) {
+			benchmark_info info{ threads, test_time_secs };
+			auto fifo_size = benchmark_default{ info }.fifo_size;
+
+			auto calibration_start = std::chrono::steady_clock::now();
+			auto tuned = block_based_queue_tuning<std::uint64_t>::calibrate(threads, fifo_size);
+			auto calibration_millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - calibration_start).count();
+
+			double tuned_throughput = 0;
+			double best_throughput = 0;
+			block_based_queue_parameters best{ 0, 0 };
+			for (double b = 0.5; b <= 16; b *= 2) {
+				for (int c = 2; c <= 2048; c *= 2) {
+					benchmark_provider_bbq<benchmark_default> provider{ "{},{},blockfifo", b, static_cast<std::size_t>(c - 1) };
+					double throughput = 0;
+					for (int i = 0; i < test_its; i++) {
+						auto result = provider.test(info, 0.5);
+						result_file << provider.get_name() << ',' << threads << ',';
+						result.output(result_file);
+						result_file << '\n';
+						throughput += static_cast<double>(std::reduce(result.results.begin(), result.results.end())) / test_time_secs / test_its;
+					}
+					if (throughput > best_throughput) {
+						best_throughput = throughput;
+						best = { b, static_cast<std::size_t>(c - 1) };
+					}
+					if (b == tuned.blocks_per_window_per_thread && static_cast<std::size_t>(c - 1) == tuned.cells_per_block) {
+						tuned_throughput = throughput;
+					}
+				}
+			}
+
+			std::cout << std::format("{} threads: autotuner picked b={}, c={} in {} ms ({} it/s); "
+				"full sweep best is b={}, c={} ({} it/s); autotuned reaches {:.1f}% of the sweep optimum",
+				threads, tuned.blocks_per_window_per_thread, tuned.cells_per_block, calibration_millis, tuned_throughput,
+				best.blocks_per_window_per_thread, best.cells_per_block, best_throughput, 100 * tuned_throughput / best_throughput) << std::endl;
+		}
+	} break;
+	case 10: {
+		// One small queue per tenant, comparing the regular and the compact layout.
+		constexpr std::size_t queue_size = 64;
+		using bbq_t = block_based_queue<std::uint64_t, std::uint8_t, counting_allocator<std::byte>>;
+		using bbq_compact_t = block_based_queue<std::uint64_t, std::uint8_t, counting_allocator<std::byte>, true>;
+
+		auto result_file = setup_file("many-queues", 0, include_header, "queue_count,bytes_per_queue,reported_bytes_per_queue,operations_per_second");
+		auto run = [&]<typename FIFO>(const char* name, int threads, double b, std::size_t c) {
+			auto result = benchmark_many_queues<FIFO>(threads, queue_count, queue_size, test_time_secs, b, c);
+			result_file << std::vformat(name, std::make_format_args(b, c)) << ',' << threads << ',' << queue_count << ','
+				<< result.bytes_per_queue << ',' << result.reported_bytes_per_queue << ',' << result.operations_per_second << std::endl;
+		};
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				run.operator()<bbq_t>("blockfifo-{}-{}", threads, 1, 7);
+				run.operator()<bbq_compact_t>("blockfifo-compact-{}-{}", threads, 1, 7);
+				run.operator()<bbq_compact_t>("blockfifo-compact-{}-{}", threads, 1, 3);
+			}
+		}
+	} break;
+	case 11: {
+		auto result_file = setup_file("reuse", 0, include_header, "size,reconstruct_nanoseconds,clear_nanoseconds,speedup");
+		for (int i = 0; i < test_its; i++) {
+			for (std::size_t size = 1 << 10; size <= 1 << 22; size <<= 4) {
+				for (std::size_t c : { 7, 63, 511 }) {
+					auto result = benchmark_reuse<block_based_queue<std::uint64_t>>(size, test_time_secs, 1., c);
+					result_file << std::format("blockfifo-{}-{}", 1, c) << ",1," << size << ',' << result.reconstruct_nanos << ','
+						<< result.clear_nanos << ',' << result.reconstruct_nanos / result.clear_nanos << std::endl;
+				}
+			}
+		}
+	} break;
+	case 12: {
+		auto result_file = setup_file("bulk-load", 0, include_header, "elements,push_nanoseconds,assign_nanoseconds");
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				std::size_t elements = element_count.value_or(1 << 24);
+				for (std::size_t c : { 7, 63, 511 }) {
+					auto result = benchmark_bulk_load<block_based_queue<std::uint64_t>>(threads, elements, 1., c);
+					result_file << std::format("blockfifo-{}-{}", 1, c) << ',' << threads << ',' << result.elements << ','
+						<< result.push_nanos << ',' << result.assign_nanos << std::endl;
+				}
+			}
+		}
+	} break;
+#ifdef __unix__
+	case 13: {
+		auto result_file = setup_file("snapshot", 0, include_header, "elements,file_bytes,save_nanoseconds,load_nanoseconds");
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				std::size_t elements = element_count.value_or(100'000'000);
+				for (std::size_t c : { 63, 511 }) {
+					auto result = benchmark_snapshot<block_based_queue<std::uint64_t>>(threads, elements, "fifo-snapshot.bin", 1., c);
+					result_file << std::format("blockfifo-{}-{}", 1, c) << ',' << threads << ',' << result.elements << ','
+						<< result.file_bytes << ',' << result.save_nanos << ',' << result.load_nanos << std::endl;
+				}
+			}
+		}
+	} break;
+#endif // __unix__
+#ifdef __linux__
+	case 14: {
+		// Producers push bursts of 16 elements every 100 microseconds, the consumer blocks in epoll in between.
+		constexpr int burst = 16;
+		constexpr std::chrono::microseconds pause{ 100 };
+		auto result_file = setup_file("epoll", 0, include_header,
+			"elements,wakeups,producer_syscalls,consumer_syscalls,syscalls_per_element,mean_wakeup_latency_nanoseconds,mean_latency_nanoseconds");
+		auto run = [&]<typename FIFO, typename... Args>(const char* name, int threads, Args... args) {
+			auto result = benchmark_epoll<FIFO>(threads, test_time_secs, burst, pause, args...);
+			result_file << std::vformat(name, std::make_format_args(args...)) << ',' << threads << ',' << result.elements << ','
+				<< result.wakeups << ',' << result.producer_syscalls << ',' << result.consumer_syscalls << ','
+				<< static_cast<double>(result.producer_syscalls + result.consumer_syscalls) / result.elements << ','
+				<< result.mean_wakeup_latency_nanos << ',' << result.mean_latency_nanos << std::endl;
+		};
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				run.operator()<block_based_queue<std::uint64_t>>("blockfifo-{}-{}", threads, 1., std::size_t{ 7 });
+				run.operator()<block_based_queue<std::uint64_t>>("blockfifo-{}-{}", threads, 1., std::size_t{ 63 });
+				run.operator()<multififo::MultiFifo<std::uint64_t>>("multififo-{}-{}", threads, 2, 1);
+				run.operator()<multififo::MultiFifo<std::uint64_t>>("multififo-{}-{}", threads, 4, 16);
+			}
+		}
+	} break;
+#endif // __linux__
+	case 15: {
+		// Keys follow a Zipf distribution with exponent 0.99 over 65536 keys, there are four shards per thread,
+		// so handles can take over shards. Only the strictly FIFO shards keep the order per key and producer.
+		constexpr std::size_t queue_size = 1 << 20;
+		constexpr std::size_t key_count = 1 << 16;
+		constexpr double zipf_s = 0.99;
+		auto result_file = setup_file("partitioned", 0, include_header, "shards,operations_per_second,takeover_ratio,order_violations");
+		auto run = [&]<typename FIFO, typename... Args>(const char* name, int threads, int shards, Args... args) {
+			auto result = benchmark_partitioned<FIFO>(threads, test_time_secs, queue_size, key_count, zipf_s, args...);
+			result_file << std::vformat(name, std::make_format_args(args...)) << ',' << threads << ',' << shards << ','
+				<< result.operations_per_second << ',' << result.takeover_ratio << ',' << result.order_violations << std::endl;
+		};
+		using bbq_t = block_based_queue<std::uint64_t>;
+		using multififo_t = multififo::MultiFifo<std::uint64_t>;
+		using faaaqueue_t = wrapper_faaaqueue<std::uint64_t>;
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				run.operator()<bbq_t>("blockfifo-{}-{}", threads, 1, 1., std::size_t{ 63 });
+				run.operator()<partitioned_fifo<bbq_t>>("partitioned-blockfifo-{}-{}-{}", threads, 4 * threads, 4 * threads, 1., std::size_t{ 63 });
+				run.operator()<partitioned_fifo<multififo_t>>("partitioned-multififo-{}-{}-{}", threads, 4 * threads, 4 * threads, 2, 1);
+				run.operator()<partitioned_fifo<faaaqueue_t>>("partitioned-faaaqueue-{}", threads, 4 * threads, 4 * threads);
+			}
+		}
+	} break;
+	case 16: {
+		// The priority queue benchmarks prefill by themselves, with random priorities.
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_pq_throughput>>> instances;
+		add_priority_instances(instances, fifo_set, is_exclude);
+		run_benchmark("pq-comp", instances, 0, processor_counts, test_its, test_time_secs, include_header, quiet);
+	} break;
+	case 17: {
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_pq_quality>>> instances;
+		add_priority_instances(instances, fifo_set, is_exclude);
+		run_benchmark("pq-quality", instances, 0, processor_counts, test_its, test_time_secs, include_header, quiet);
+	} break;
+	case 18: {
+		auto [graph_file, graph] = read_and_test_graph(argc, argv);
+
+		auto result_file = setup_file(std::format("dfs-{}", graph_file.filename().string()), 0, include_header, benchmark_dfs::header);
+
+		for (int i = 0; i < test_its; i++) {
+			auto [time, visited] = sequential_dfs(graph);
+			result_file << "sequential," << (processor_counts.size() == 1 ? processor_counts[0] : 1) << "," << time << "," << visited << std::endl;
+		}
+
+		// Reachability is checked against the BFS distances.
+		auto [bfs_time, dist, distances] = sequential_bfs(graph);
+
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_dfs>>> instances;
+#if !defined(INCLUDE_BBS)
+		add_stack_instances(instances);
+#endif
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		run_benchmark_raw<benchmark_dfs, benchmark_info_graph, const Graph&, const std::vector<std::uint32_t>&>(
+			result_file, instances, 0, processor_counts, test_its, 0, quiet, graph, distances);
+	} break;
+	case 19: {
+		// Delays of up to 10 ms on a wheel of 256 slots of 100 microseconds each.
+		constexpr std::size_t queue_size = 1 << 22;
+		constexpr std::size_t slot_count = 256;
+		constexpr std::chrono::microseconds slot_duration{ 100 };
+		constexpr std::chrono::milliseconds max_delay{ 10 };
+		auto result_file = setup_file("delay-queue", 0, include_header,
+			"pushes_per_second,pops_per_second,failed_pushes,early_pops,mean_lateness_nanoseconds");
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				for (std::size_t c : { 7, 63 }) {
+					auto result = benchmark_delay_queue(threads, test_time_secs, queue_size, slot_count, slot_duration, max_delay, 1., c);
+					result_file << std::format("delayqueue-{}-{}-{}", slot_count, 1, c) << ',' << threads << ','
+						<< result.pushes_per_second << ',' << result.pops_per_second << ',' << result.failed_pushes << ','
+						<< result.early_pops << ',' << result.mean_lateness_nanos << std::endl;
+				}
+			}
+		}
+	} break;
+	case 20: {
+		// 16 queues weighted 1, 2, 4, 8, 1, 2, ..., of which only the first 4 receive elements.
+		constexpr std::size_t queue_size = 1 << 16;
+		constexpr std::size_t active_count = 4;
+		std::vector<std::uint64_t> weights;
+		for (std::size_t i = 0; i < 16; i++) {
+			weights.push_back(1ull << (i % 4));
+		}
+		using bbq_t = block_based_queue<std::uint64_t>;
+		auto result_file = setup_file("weighted", 0, include_header, "pops_per_second,max_share_deviation");
+		auto run = [&]<template <typename, typename> typename CONSUMER>(const char* name, int threads) {
+			auto result = benchmark_weighted<CONSUMER, bbq_t>(threads, test_time_secs, queue_size, weights, active_count, 1., std::size_t{ 63 });
+			result_file << name << ',' << threads << ',' << result.pops_per_second << ',' << result.max_share_deviation << std::endl;
+		};
+		for (int i = 0; i < test_its; i++) {
+			for (auto threads : processor_counts) {
+				run.operator()<weighted_consumer>("drr-blockfifo-1-63", threads);
+				run.operator()<round_robin_consumer>("roundrobin-blockfifo-1-63", threads);
+			}
+		}
+	} break;
+	case 21: {
+		// The usual processor counts, followed by twice as many threads as processors available for pinning, which puts two
+		// threads on every processor. Smaller counts are never oversubscribed, as threads are pinned round robin.
+		std::vector<int> oversubscribed_counts = processor_counts;
+		oversubscribed_counts.push_back(2 * thread_pinning::cpu_count());
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_default>>> instances;
+		add_backoff_instances(instances, fifo_set, is_exclude);
+		run_benchmark("backoff", instances, prefill_override.value_or(0.5), oversubscribed_counts, test_its, test_time_secs, include_header, quiet);
+	} break;
+	case 22: {
+		// 1x to 4x as many threads as processors available for pinning (all of them, unless restricted with --pin).
+		std::vector<int> oversubscribed_counts;
+		for (int factor = 1; factor <= 4; factor++) {
+			oversubscribed_counts.push_back(factor * thread_pinning::cpu_count());
+		}
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_latency>>> instances;
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		run_benchmark("oversubscription", instances, prefill_override.value_or(0.5), oversubscribed_counts, test_its, test_time_secs, include_header, quiet);
+	} break;
+	case 23: {
+		// Offered loads from well below to beyond what the queues sustain, where latency grows with the run time.
+		constexpr std::array rates{ 1e5, 1e6, 3e6, 1e7, 3e7, 1e8 };
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_open_loop>>> instances;
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		for (bool poisson : { true, false }) {
+			auto result_file = setup_file(poisson ? "openloop-poisson" : "openloop-constant", 0, include_header, benchmark_open_loop::header);
+			for (double rate : rates) {
+				// Prefilled elements would be taken for timestamps.
+				run_benchmark_raw<benchmark_open_loop, benchmark_info_open_loop, double, bool>(
+					result_file, instances, 0, processor_counts, test_its, test_time_secs, quiet, rate, poisson);
+			}
+		}
+	} break;
+	case 24: {
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_synthetic>>> instances;
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		run_benchmark<benchmark_synthetic, benchmark_info_synthetic, double, std::uint64_t, int, std::string>(
+			std::format("synthetic-{}-{}-{}-{}", pop_ratio, think_nanos, burst, roles), instances, prefill_override.value_or(0.5),
+			processor_counts, test_its, test_time_secs, include_header, quiet, pop_ratio, think_nanos, burst, roles);
+	} break;
+	case 25: {
+		// Without --stages: source, one middle stage and sink, sharing the processors evenly.
+		if (stage_threads.empty()) {
+			stage_threads.assign(3, std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 3));
+		}
+		int total_threads = std::reduce(stage_threads.begin(), stage_threads.end());
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_pipeline>>> instances;
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		run_benchmark<benchmark_pipeline, benchmark_info_pipeline, std::vector<int>, std::uint64_t, double>(
+			std::format("pipeline-{}-{}", stage_work_nanos, source_rate), instances, 0, { total_threads }, test_its, test_time_secs, include_header, quiet,
+			stage_threads, stage_work_nanos, source_rate);
+	} break;
+	case 26: {
+		constexpr std::uint64_t fib_n = 36;
+		constexpr std::uint64_t uts_root_children = 2000;
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_fork_join>>> instances;
+		add_instances(instances, parameter_tuning, fifo_set, is_exclude);
+		for (auto [name, workload, size] : { std::tuple{ "fib", fork_join_workload::FIB, fib_n }, std::tuple{ "uts", fork_join_workload::UTS, uts_root_children } }) {
+			auto result_file = setup_file(std::format("forkjoin-{}-{}", name, size), 0, include_header, benchmark_fork_join::header);
+			std::uint64_t expected = 0;
+			for (int i = 0; i < test_its; i++) {
+				auto [time, result, tasks] = fork_join::sequential(workload, size);
+				result_file << "sequential,1," << time << ',' << result << ',' << tasks << std::endl;
+				expected = result;
+			}
+			run_benchmark_raw<benchmark_fork_join, benchmark_info_fork_join, fork_join_workload, std::uint64_t, std::uint64_t>(
+				result_file, instances, 0, processor_counts, test_its, 0, quiet, workload, size, expected);
+		}
+	} break;
+	case 27: {
+		// Every workload runs on the pool and, for comparison, with the queue as the only task pool.
+		auto [graph_file, graph] = read_and_test_graph(argc, argv);
+
+		constexpr std::uint64_t fib_n = 36;
+		constexpr std::uint64_t uts_root_children = 2000;
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_fork_join>>> global_instances;
+		add_pool_instances(global_instances, fifo_set, is_exclude);
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_fork_join_pool>>> pool_instances;
+		add_pool_instances(pool_instances, fifo_set, is_exclude);
+		for (auto [name, workload, size] : { std::tuple{ "fib", fork_join_workload::FIB, fib_n }, std::tuple{ "uts", fork_join_workload::UTS, uts_root_children } }) {
+			auto expected = std::get<1>(fork_join::sequential(workload, size));
+			auto global_file = setup_file(std::format("globalqueue-{}-{}", name, size), 0, include_header, benchmark_fork_join::header);
+			run_benchmark_raw<benchmark_fork_join, benchmark_info_fork_join, fork_join_workload, std::uint64_t, std::uint64_t>(
+				global_file, global_instances, 0, processor_counts, test_its, 0, quiet, workload, size, expected);
+			auto pool_file = setup_file(std::format("workstealing-{}-{}", name, size), 0, include_header, benchmark_fork_join::header);
+			run_benchmark_raw<benchmark_fork_join_pool, benchmark_info_fork_join, fork_join_workload, std::uint64_t, std::uint64_t>(
+				pool_file, pool_instances, 0, processor_counts, test_its, 0, quiet, workload, size, expected);
+		}
+
+		auto distances = std::get<2>(sequential_bfs(graph));
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_bfs>>> global_bfs_instances;
+		add_pool_instances(global_bfs_instances, fifo_set, is_exclude);
+		auto global_file = setup_file(std::format("globalqueue-bfs-{}", graph_file.filename().string()), 0, include_header, benchmark_bfs::header);
+		run_benchmark_raw<benchmark_bfs, benchmark_info_graph, const Graph&, const std::vector<std::uint32_t>&>(
+			global_file, global_bfs_instances, 0, processor_counts, test_its, 0, quiet, graph, distances);
+		std::vector<std::unique_ptr<benchmark_provider<benchmark_bfs_pool>>> pool_bfs_instances;
+		add_pool_instances(pool_bfs_instances, fifo_set, is_exclude);
+		auto pool_file = setup_file(std::format("workstealing-bfs-{}", graph_file.filename().string()), 0, include_header, benchmark_bfs::header);
+		run_benchmark_raw<benchmark_bfs_pool, benchmark_info_graph, const Graph&, const std::vector<std::uint32_t>&>(
+			pool_file, pool_bfs_instances, 0, processor_counts, test_its, 0, quiet, graph, distances);
+	} break;
 	}
 
 	return 0;
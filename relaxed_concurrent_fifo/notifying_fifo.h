@@ -0,0 +1,125 @@
+#ifndef NOTIFYING_FIFO_H_INCLUDED
+#define NOTIFYING_FIFO_H_INCLUDED
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "fifo.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif // __GNUC__
+
+// Wraps any fifo and signals an eventfd when it goes from empty to non-empty, so consumers can wait on it with epoll.
+// Notifications are edge-coalesced: The consumer arms the notifier once it has found the queue empty (via pop_or_arm)
+// and only the first push afterwards writes to the eventfd, all other pushes get away with a single load.
+// As with the underlying queue's pop, emptiness is only detected as reliably as FIFO allows.
+template <typename FIFO, typename T = std::uint64_t>
+class notifying_fifo {
+private:
+	FIFO fifo;
+	int event_fd;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_bool armed = true;
+	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t notify_count = 0;
+
+	void notify() {
+		// Pairs with the fence in pop_or_arm: Either we see the consumer being armed, or it sees our element.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (armed.load(std::memory_order_relaxed) && armed.exchange(false, std::memory_order_relaxed)) {
+			std::uint64_t one = 1;
+			[[maybe_unused]] auto written = ::write(event_fd, &one, sizeof(one));
+			notify_count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+public:
+	template <typename... Args>
+	notifying_fifo(int thread_count, std::size_t size, Args&&... args) :
+			fifo(thread_count, size, std::forward<Args>(args)...),
+			event_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+		if (event_fd < 0) {
+			throw std::runtime_error("Failed to create eventfd");
+		}
+	}
+
+	~notifying_fifo() {
+		close(event_fd);
+	}
+
+	notifying_fifo(const notifying_fifo&) = delete;
+	notifying_fifo& operator=(const notifying_fifo&) = delete;
+
+	// Becomes readable after a push into an empty, armed queue; register it with epoll (EPOLLIN).
+	int fd() const { return event_fd; }
+
+	// Resets the eventfd after it became readable.
+	void consume_notification() {
+		std::uint64_t value;
+		[[maybe_unused]] auto read = ::read(event_fd, &value, sizeof(value));
+	}
+
+	// Amount of eventfd writes performed by producers so far.
+	std::uint64_t notifications() const {
+		return notify_count.load(std::memory_order_relaxed);
+	}
+
+	class handle {
+	private:
+		notifying_fifo* parent;
+		typename FIFO::handle inner;
+
+		handle(notifying_fifo* parent) : parent(parent), inner(parent->fifo.get_handle()) { }
+
+		friend notifying_fifo;
+
+	public:
+		bool push(T t) {
+			if (!inner.push(std::move(t))) {
+				return false;
+			}
+			parent->notify();
+			return true;
+		}
+
+		std::optional<T> pop() {
+			return inner.pop();
+		}
+
+		// Pops an element, arming the notifier if there is none. Once this returned std::nullopt,
+		// it is safe to wait on fd(), no push after that will go unnoticed.
+		std::optional<T> pop_or_arm() {
+			if (auto ret = inner.pop(); ret.has_value()) {
+				return ret;
+			}
+			parent->armed.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto ret = inner.pop();
+			if (ret.has_value()) {
+				// A producer that raced with us might have notified already, which only causes a spurious wakeup.
+				parent->armed.store(false, std::memory_order_relaxed);
+			}
+			return ret;
+		}
+	};
+
+	handle get_handle() { return handle(this); }
+};
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#endif // __linux__
+
+#endif // NOTIFYING_FIFO_H_INCLUDED
@@ -0,0 +1,218 @@
+#ifndef PARTITIONED_FIFO_H_INCLUDED
+#define PARTITIONED_FIFO_H_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "fifo.h"
+#include "utility.h"
+
+// Spreads elements over shard_count independent queues by the hash of a key, so all elements of one key end up
+// in the same shard. Every shard is consumed by exactly one handle at a time, its owner: On its first pop, a handle
+// claims its home shard, assigned round-robin on creation, and it only pops from shards it owns, so handles that only
+// push never hold on to a shard. Once all of its shards are empty, a handle takes over a whole shard instead of
+// stealing single elements, either an unowned one or by asking the owner of another, which hands the shard over at
+// the start of its next pop if it has another one left. As the previous owner has finished with all elements it
+// popped from the shard by then, elements of one key pushed by the same handle are popped and processed in the order
+// they were pushed, provided that the shards are strictly FIFO. With relaxed shards such as block_based_queue, a
+// single consumer still sees the shard's own reorderings.
+// Handles may be moved, but not assigned to; destroying one releases its shards.
+template <typename FIFO, typename T = std::uint64_t>
+class partitioned_fifo {
+private:
+	static constexpr int NO_HANDLE = -1;
+
+	struct shard_state {
+		std::atomic_int owner = NO_HANDLE;
+		// A handle asking the owner to hand over the shard.
+		std::atomic_int requested_by = NO_HANDLE;
+	};
+
+	std::vector<std::unique_ptr<FIFO>> shards;
+	std::vector<cache_aligned_t<shard_state>> states;
+	std::atomic_size_t next_home = 0;
+	std::atomic_int next_id = 0;
+
+	std::size_t shard_of(std::uint64_t key) const {
+		// Fibonacci hashing, as keys are often sequential.
+		return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ull) >> 32) % shards.size();
+	}
+
+public:
+	template <typename... Args>
+	partitioned_fifo(int thread_count, std::size_t size, int shard_count, Args&&... args) : states(shard_count) {
+		shards.reserve(shard_count);
+		for (int i = 0; i < shard_count; i++) {
+			shards.push_back(std::make_unique<FIFO>(thread_count, size / shard_count, args...));
+		}
+	}
+
+	std::size_t shard_count() const {
+		return shards.size();
+	}
+
+	class handle {
+	private:
+		partitioned_fifo* fifo;
+		std::vector<typename FIFO::handle> shard_handles;
+		int id;
+		std::size_t home;
+		std::vector<std::size_t> owned;
+		std::size_t next_owned = 0;
+		// Shard this handle asked to be handed over, if any.
+		std::optional<std::size_t> pending;
+		std::uint64_t takeover_count = 0;
+
+		handle(partitioned_fifo* fifo) : fifo(fifo), id(fifo->next_id++), home(fifo->next_home++ % fifo->shards.size()) {
+			shard_handles.reserve(fifo->shards.size());
+			for (auto& shard : fifo->shards) {
+				shard_handles.push_back(shard->get_handle());
+			}
+		}
+
+		friend partitioned_fifo;
+
+		shard_state& state(std::size_t shard) {
+			return fifo->states[shard];
+		}
+
+		void take(std::size_t shard) {
+			owned.push_back(shard);
+			if (shard != home) {
+				takeover_count++;
+			}
+		}
+
+		// Answers requests for owned shards, handing one over as long as another one remains.
+		void serve_requests() {
+			for (std::size_t i = 0; i < owned.size(); i++) {
+				auto& s = state(owned[i]);
+				int requester = s.requested_by.load(std::memory_order_relaxed);
+				if (requester == NO_HANDLE) {
+					continue;
+				}
+				if (owned.size() > 1) {
+					// Publishes everything popped from the shard so far to the new owner.
+					s.owner.store(requester, std::memory_order_release);
+					owned.erase(owned.begin() + i);
+					i--;
+				}
+				// Only answered after the ownership changed, so the requester always sees the outcome.
+				s.requested_by.store(NO_HANDLE, std::memory_order_release);
+			}
+		}
+
+		// Whether a previous request was granted. A denied one is given up, so that the next shard can be asked,
+		// as is one for a shard that was released in the meantime, which can then be claimed directly.
+		void check_pending() {
+			if (!pending.has_value()) {
+				return;
+			}
+			auto& s = state(*pending);
+			int requester = s.requested_by.load(std::memory_order_acquire);
+			int owner = s.owner.load(std::memory_order_acquire);
+			if (requester != id) {
+				if (owner == id) {
+					take(*pending);
+				}
+				pending.reset();
+			} else if (owner == NO_HANDLE && s.requested_by.compare_exchange_strong(requester, NO_HANDLE, std::memory_order_relaxed)) {
+				pending.reset();
+			}
+		}
+
+		// Claims an unowned shard right away, otherwise asks the owner of a shard for it.
+		bool take_over() {
+			check_pending();
+			for (std::size_t i = 0; i < shard_handles.size(); i++) {
+				std::size_t victim = (home + i) % shard_handles.size();
+				auto& s = state(victim);
+				int owner = s.owner.load(std::memory_order_relaxed);
+				if (owner == id || victim == pending) {
+					continue;
+				}
+				if (owner == NO_HANDLE) {
+					if (s.owner.compare_exchange_strong(owner, id, std::memory_order_acquire)) {
+						take(victim);
+						return true;
+					}
+				} else if (!pending.has_value()) {
+					int expected = NO_HANDLE;
+					if (s.requested_by.compare_exchange_strong(expected, id, std::memory_order_relaxed)) {
+						pending = victim;
+					}
+				}
+			}
+			return false;
+		}
+
+		void release_all() {
+			if (pending.has_value()) {
+				int expected = id;
+				state(*pending).requested_by.compare_exchange_strong(expected, NO_HANDLE, std::memory_order_acquire);
+				// The request might have been granted in the meantime.
+				if (state(*pending).owner.load(std::memory_order_acquire) == id) {
+					owned.push_back(*pending);
+				}
+				pending.reset();
+			}
+			for (auto shard : owned) {
+				state(shard).owner.store(NO_HANDLE, std::memory_order_release);
+			}
+			owned.clear();
+		}
+
+	public:
+		handle(handle&& other) : fifo(std::exchange(other.fifo, nullptr)), shard_handles(std::move(other.shard_handles)), id(other.id),
+			home(other.home), owned(std::exchange(other.owned, {})), next_owned(other.next_owned),
+			pending(std::exchange(other.pending, std::nullopt)), takeover_count(other.takeover_count) { }
+		handle& operator=(handle&&) = delete;
+
+		~handle() {
+			if (fifo != nullptr) {
+				release_all();
+			}
+		}
+
+		bool push(std::uint64_t key, T t) {
+			return shard_handles[fifo->shard_of(key)].push(std::move(t));
+		}
+
+		// Uses the element itself as its key.
+		bool push(T t) {
+			return push(static_cast<std::uint64_t>(t), std::move(t));
+		}
+
+		std::optional<T> pop() {
+			serve_requests();
+			for (int attempt = 0; attempt < 2; attempt++) {
+				// Owned shards are served in turn, starting after the last one popped from.
+				for (std::size_t i = 0; i < owned.size(); i++) {
+					std::size_t index = (next_owned + i) % owned.size();
+					if (auto ret = shard_handles[owned[index]].pop(); ret.has_value()) {
+						next_owned = index + 1;
+						return ret;
+					}
+				}
+				if (!take_over()) {
+					break;
+				}
+			}
+			return std::nullopt;
+		}
+
+		// Amount of shards other than its home shard this handle took over after its owned shards ran empty.
+		std::uint64_t takeovers() const {
+			return takeover_count;
+		}
+	};
+
+	handle get_handle() { return handle(this); }
+};
+
+#endif // PARTITIONED_FIFO_H_INCLUDED
@@ -0,0 +1,132 @@
+#ifndef WEIGHTED_CONSUMER_H_INCLUDED
+#define WEIGHTED_CONSUMER_H_INCLUDED
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "fifo.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif // __GNUC__
+
+// Serves pops from up to 64 queues by deficit round robin, so that while queues are backlogged, queue i receives
+// a share of the pops proportional to weights[i]. Every handle keeps its own round robin position and deficits.
+// A shared mask of possibly non-empty queues lets pops skip empty queues without touching them. All bits start set,
+// so elements already in the queues are found; a queue's bit is cleared by a pop finding it empty, which then pops
+// once more, and notify sets the bit after a push if it is not set, so one of the two always notices the other.
+// Pushes through a handle notify on their own. Producers pushing into the queues directly must call notify with the
+// queue's index after every push, otherwise their elements may never be popped.
+template <typename FIFO, typename T = std::uint64_t>
+class weighted_consumer {
+private:
+	std::vector<FIFO*> queues;
+	std::vector<std::uint64_t> weights;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t nonempty_mask;
+
+public:
+	weighted_consumer(std::vector<FIFO*> queues, std::vector<std::uint64_t> weights) : queues(std::move(queues)), weights(std::move(weights)) {
+		if (this->queues.size() > 64 || this->queues.size() != this->weights.size()) {
+			throw std::runtime_error("Please use at most 64 queues and exactly one weight per queue");
+		}
+		for (auto weight : this->weights) {
+			if (weight == 0) {
+				throw std::runtime_error("Please only use positive weights");
+			}
+		}
+		nonempty_mask = this->queues.size() == 64 ? ~0ull : (1ull << this->queues.size()) - 1;
+	}
+
+	std::size_t queue_count() const {
+		return queues.size();
+	}
+
+	// Announces an element pushed into queue index, to be called after the push.
+	void notify(std::size_t index) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if ((nonempty_mask.load(std::memory_order_relaxed) & (1ull << index)) == 0) {
+			nonempty_mask.fetch_or(1ull << index, std::memory_order_relaxed);
+		}
+	}
+
+	class handle {
+	private:
+		weighted_consumer& consumer;
+		std::vector<typename FIFO::handle> queue_handles;
+		std::vector<std::uint64_t> deficits;
+		std::size_t current = 0;
+
+		handle(weighted_consumer& consumer) : consumer(consumer), deficits(consumer.queues.size(), 0) {
+			queue_handles.reserve(consumer.queues.size());
+			for (auto* queue : consumer.queues) {
+				queue_handles.push_back(queue->get_handle());
+			}
+		}
+
+		friend weighted_consumer;
+
+		// Next queue after current in round robin order with its bit set in mask, which must not be 0.
+		std::size_t next_queue(std::uint64_t mask) const {
+			std::size_t after = current + 1;
+			std::uint64_t upper = after >= 64 ? 0 : mask & (~0ull << after);
+			return std::countr_zero(upper != 0 ? upper : mask);
+		}
+
+		std::optional<T> pop_nonempty(std::size_t index) {
+			if (auto ret = queue_handles[index].pop(); ret.has_value()) {
+				return ret;
+			}
+			consumer.nonempty_mask.fetch_and(~(1ull << index), std::memory_order_seq_cst);
+			if (auto ret = queue_handles[index].pop(); ret.has_value()) {
+				consumer.nonempty_mask.fetch_or(1ull << index, std::memory_order_relaxed);
+				return ret;
+			}
+			return std::nullopt;
+		}
+
+	public:
+		bool push(std::size_t index, T t) {
+			if (!queue_handles[index].push(std::move(t))) {
+				return false;
+			}
+			consumer.notify(index);
+			return true;
+		}
+
+		std::optional<T> pop() {
+			while (true) {
+				std::uint64_t mask = consumer.nonempty_mask.load(std::memory_order_relaxed);
+				if (mask == 0) {
+					return std::nullopt;
+				}
+				if (deficits[current] == 0 || (mask & (1ull << current)) == 0) {
+					// A queue that ran empty loses its remaining deficit.
+					deficits[current] = 0;
+					current = next_queue(mask);
+					deficits[current] += consumer.weights[current];
+					continue;
+				}
+				if (auto ret = pop_nonempty(current); ret.has_value()) {
+					deficits[current]--;
+					return ret;
+				}
+				deficits[current] = 0;
+			}
+		}
+	};
+
+	handle get_handle() { return handle(*this); }
+};
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#endif // WEIGHTED_CONSUMER_H_INCLUDED
@@ -0,0 +1,305 @@
+#ifndef WORK_STEALING_POOL_H_INCLUDED
+#define WORK_STEALING_POOL_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <random>
+#include <stdexcept>
+
+#include "backoff.h"
+#include "utility.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif // __GNUC__
+
+// Bounded Chase-Lev deque (with the memory orderings of Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). The owner pushes and pops at the bottom, any other thread may steal from the top.
+template <typename T>
+class chase_lev_deque {
+private:
+	alignas(std::hardware_destructive_interference_size) std::atomic<std::int64_t> top = 0;
+	alignas(std::hardware_destructive_interference_size) std::atomic<std::int64_t> bottom = 0;
+	std::size_t capacity;
+	std::unique_ptr<std::atomic<T>[]> buffer;
+
+	std::atomic<T>& slot(std::int64_t index) {
+		return buffer[modulo_po2(static_cast<std::size_t>(index), capacity)];
+	}
+
+public:
+	chase_lev_deque(std::size_t capacity) : capacity(capacity), buffer(std::make_unique<std::atomic<T>[]>(capacity)) {
+		if (!is_po2(capacity)) {
+			throw std::runtime_error("Please only use capacities that are a power of two");
+		}
+	}
+
+	// Owner only. Fails if the deque is full.
+	bool push(T t) {
+		auto b = bottom.load(std::memory_order_relaxed);
+		auto t_index = top.load(std::memory_order_acquire);
+		if (b - t_index >= static_cast<std::int64_t>(capacity)) {
+			return false;
+		}
+		slot(b).store(t, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Owner only, returns the most recently pushed element.
+	std::optional<T> pop() {
+		auto b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto t_index = top.load(std::memory_order_relaxed);
+		if (t_index > b) {
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+		T t = slot(b).load(std::memory_order_relaxed);
+		if (t_index == b) {
+			// Last element, race against thieves for it.
+			bool won = top.compare_exchange_strong(t_index, t_index + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			if (!won) {
+				return std::nullopt;
+			}
+		}
+		return t;
+	}
+
+	// Any thread, returns the least recently pushed element. May spuriously fail under contention.
+	std::optional<T> steal() {
+		auto t_index = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto b = bottom.load(std::memory_order_acquire);
+		if (t_index >= b) {
+			return std::nullopt;
+		}
+		T t = slot(t_index).load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(t_index, t_index + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return std::nullopt;
+		}
+		return t;
+	}
+};
+
+// Order in which a worker runs the tasks of its own deque. LIFO suits divide-and-conquer (depth-first, small deques),
+// FIFO suits level-synchronous work like BFS. Other workers always steal the oldest tasks.
+enum class local_order {
+	LIFO,
+	FIFO,
+};
+
+// Thread pool scheduler for tasks that spawn further tasks. Every worker owns a Chase-Lev deque that it pushes spawned
+// tasks to and runs them from; a shared fifo (e.g. a block_based_queue or MultiFifo) takes injected tasks and the
+// overflow of full deques. Idle workers look at their own deque, then the shared fifo, then steal from the other workers,
+// and finally park until new work is spawned. work() returns once all spawned tasks have been processed.
+//
+// The pool does not own its threads or the shared fifo: Every thread calls work() with its own handle to the fifo,
+// which lets the benchmark harness keep control of thread creation, pinning and timing. A pool runs a single computation.
+template <typename T = std::uint64_t>
+class work_stealing_pool {
+private:
+	// Failed rounds of looking for work before an idle worker parks.
+	static constexpr int SPIN_ROUNDS = 64;
+	// Relaxed fifos may miss an element on pop while it is already in the queue, which can cause a lost wakeup.
+	// Parked workers therefore wake up on their own after this long.
+	static constexpr std::chrono::microseconds PARK_TIMEOUT{ 500 };
+
+	struct worker_state {
+		chase_lev_deque<T> deque;
+		// Tasks are counted as spawned before they become visible and as completed after all their children were spawned.
+		alignas(std::hardware_destructive_interference_size) std::atomic_uint64_t spawned = 0;
+		std::atomic_uint64_t completed = 0;
+
+		worker_state(std::size_t local_capacity) : deque(local_capacity) { }
+	};
+
+	int worker_count;
+	local_order order;
+	std::unique_ptr<std::unique_ptr<worker_state>[]> workers;
+
+	alignas(std::hardware_destructive_interference_size) std::atomic_int sleepers = 0;
+	std::atomic_uint64_t wake_epoch = 0;
+	std::atomic_bool done = false;
+	std::mutex park_mutex;
+	std::condition_variable park_cv;
+
+	// Counters are monotonic and a task's spawn happens before its completion, so reading all completions before
+	// all spawns and finding them equal means that no task was in flight in between. As tasks are only spawned by
+	// other tasks, none ever will be again.
+	bool quiescent() const {
+		std::uint64_t completed = 0;
+		for (int i = 0; i < worker_count; i++) {
+			completed += workers[i]->completed.load(std::memory_order_seq_cst);
+		}
+		std::uint64_t spawned = 0;
+		for (int i = 0; i < worker_count; i++) {
+			spawned += workers[i]->spawned.load(std::memory_order_seq_cst);
+		}
+		return completed == spawned;
+	}
+
+	void wake_one() {
+		// Pairs with the increment of sleepers in park: Either we see the sleeper, or its last look finds our task.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepers.load(std::memory_order_relaxed) > 0) {
+			{
+				std::scoped_lock lock{ park_mutex };
+				wake_epoch.fetch_add(1, std::memory_order_relaxed);
+			}
+			park_cv.notify_one();
+		}
+	}
+
+	void finish() {
+		{
+			std::scoped_lock lock{ park_mutex };
+			done = true;
+		}
+		park_cv.notify_all();
+	}
+
+public:
+	template <typename HANDLE>
+	class worker {
+	private:
+		work_stealing_pool& pool;
+		worker_state& state;
+		HANDLE& global;
+		int index;
+		std::minstd_rand rng;
+		bool err = false;
+
+		friend work_stealing_pool;
+
+		worker(work_stealing_pool& pool, int index, HANDLE& global) :
+			pool(pool), state(*pool.workers[index]), global(global), index(index), rng(index) { }
+
+		std::optional<T> find_task() {
+			if (auto t = pool.order == local_order::LIFO ? state.deque.pop() : state.deque.steal()) {
+				return t;
+			}
+			if (auto t = global.pop()) {
+				return t;
+			}
+			if (pool.worker_count > 1) {
+				int victim = static_cast<int>(rng() % pool.worker_count);
+				for (int i = 0; i < pool.worker_count; i++, victim = victim + 1 == pool.worker_count ? 0 : victim + 1) {
+					if (victim == index) {
+						continue;
+					}
+					if (auto t = pool.workers[victim]->deque.steal()) {
+						return t;
+					}
+				}
+			}
+			return std::nullopt;
+		}
+
+	public:
+		// Makes t available to all workers, pushing it to the local deque or the shared fifo if the deque is full.
+		// Returns false if neither had room, in which case the task is lost.
+		bool push(T t) {
+			state.spawned.fetch_add(1, std::memory_order_relaxed);
+			if (!state.deque.push(t) && !global.push(t)) {
+				state.completed.fetch_add(1, std::memory_order_relaxed);
+				err = true;
+				return false;
+			}
+			pool.wake_one();
+			return true;
+		}
+
+		// Bypasses the local deque, e.g. for root tasks that should be picked up by any worker.
+		bool inject(T t) {
+			state.spawned.fetch_add(1, std::memory_order_relaxed);
+			if (!global.push(t)) {
+				state.completed.fetch_add(1, std::memory_order_relaxed);
+				err = true;
+				return false;
+			}
+			pool.wake_one();
+			return true;
+		}
+
+		int get_index() const { return index; }
+
+		// Whether any push of this worker failed.
+		bool failed() const { return err; }
+	};
+
+	work_stealing_pool(int worker_count, std::size_t local_capacity, local_order order = local_order::LIFO) :
+			worker_count(worker_count),
+			order(order),
+			workers(std::make_unique<std::unique_ptr<worker_state>[]>(worker_count)) {
+		for (int i = 0; i < worker_count; i++) {
+			workers[i] = std::make_unique<worker_state>(local_capacity);
+		}
+	}
+
+	work_stealing_pool(const work_stealing_pool&) = delete;
+	work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+	template <typename HANDLE>
+	worker<HANDLE> get_worker(int index, HANDLE& global) {
+		return worker<HANDLE>{ *this, index, global };
+	}
+
+	// Runs tasks via f(task, worker) until the pool is quiescent. Must be called by every worker exactly once;
+	// root tasks have to be pushed before any worker can observe the pool as idle, i.e. before all workers call work().
+	template <typename HANDLE, typename F>
+	void work(worker<HANDLE>& w, F&& f) {
+		int failed_rounds = 0;
+		while (!done.load(std::memory_order_relaxed)) {
+			if (auto t = w.find_task()) {
+				failed_rounds = 0;
+				f(*t, w);
+				w.state.completed.fetch_add(1, std::memory_order_release);
+				continue;
+			}
+
+			if (++failed_rounds < SPIN_ROUNDS) {
+				cpu_pause();
+				continue;
+			}
+			failed_rounds = 0;
+
+			auto epoch = wake_epoch.load(std::memory_order_relaxed);
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+			if (auto t = w.find_task()) {
+				sleepers.fetch_sub(1, std::memory_order_relaxed);
+				f(*t, w);
+				w.state.completed.fetch_add(1, std::memory_order_release);
+				continue;
+			}
+			if (quiescent()) {
+				sleepers.fetch_sub(1, std::memory_order_relaxed);
+				finish();
+				break;
+			}
+			{
+				std::unique_lock lock{ park_mutex };
+				park_cv.wait_for(lock, PARK_TIMEOUT, [&]() {
+					return done.load(std::memory_order_relaxed) || wake_epoch.load(std::memory_order_relaxed) != epoch;
+				});
+			}
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+};
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif // __GNUC__
+
+#endif // WORK_STEALING_POOL_H_INCLUDED